@@ -0,0 +1,726 @@
+namespace SimulationUtilities{
+
+	//block structured adaptive mesh refinement. every level is a set of blocks of blockSize^dimensions
+	//cells, each a GhostedTensorField, so gradients and expressions run on a block as on any field.
+	//level 0 covers the domain, the blocks of level l + 1 are the 2^dimensions halves (refinement
+	//ratio 2) of the level l blocks picked for refinement. data is cell centred: cell i of level l sits
+	//at (i + 0.5) * spacing(l). the levels stay properly nested (a refined block's neighbours are on
+	//its level too), so coarse-fine ghost cells are always interpolated from the level just below.
+	template<size_t dimensions, size_t rank, size_t blockSize = 16, typename T = double,
+		size_t ghosts = FourthOrderFirstDerivative::radius>
+	class AdaptiveTensorField
+	{
+		static_assert(blockSize % 2 == 0 && blockSize > ghosts, "blockSize has to be even and larger than ghosts.");
+	public:
+		typedef GhostedTensorField<dimensions, rank, T, ghosts> Block;
+		typedef std::array<size_t, dimensions> Position;
+	private:
+		static constexpr size_t components = Template_Power<dimensions, rank>::value;
+		static constexpr size_t blockCells = Template_Power<blockSize, dimensions>::value;
+		typedef std::array<T, components> Value;
+		typedef std::array<std::ptrdiff_t, dimensions> Cell;
+
+		struct Level
+		{
+			std::vector<Position> positions;//in blocks
+			std::vector<Block> blocks;
+			std::map<Position, size_t> lookup;
+			//local() data from the start of the step while the next level subcycles. values are read
+			//as previous + blend * (current - previous), blend being the finer level's time fraction.
+			std::vector<std::shared_ptr<T[]>> previous;
+			double blend = 1;
+
+			void add(const Position& position)
+			{
+				lookup[position] = positions.size();
+				positions.push_back(position);
+				Position interior;
+				interior.fill(blockSize);
+				blocks.emplace_back(interior);
+			}
+		};
+
+		Position baseBlocks;
+		double baseSpacing;
+		size_t maxLevels;
+		std::vector<Level> levels;
+		std::array<std::array<GhostBoundary<T>, 2>, dimensions> boundaries;
+
+		size_t levelBlocks(size_t level, size_t axis) const
+		{
+			return baseBlocks[axis] << level;
+		}
+
+		//position of point in a cube of edge cells, row major
+		static Position unflatten(size_t point, size_t edge)
+		{
+			Position output;
+			for (size_t axis = dimensions; axis > 0; --axis)
+			{
+				output[axis - 1] = point % edge;
+				point /= edge;
+			}
+			return output;
+		}
+
+		static T minmod(T left, T right)
+		{
+			if (left * right <= 0)
+			{
+				return T();
+			}
+			return std::abs(left) < std::abs(right) ? left : right;
+		}
+
+		//brings cell into the domain of level through periodic sides, other sides clamp the cell
+		//(giving zero slopes at the edge)
+		void wrap(size_t level, Cell& cell) const
+		{
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				std::ptrdiff_t cells = (std::ptrdiff_t)(levelBlocks(level, axis) * blockSize);
+				if (cell[axis] >= 0 && cell[axis] < cells)
+				{
+					continue;
+				}
+				if (boundaries[axis][cell[axis] < 0 ? 0 : 1].condition == GhostCondition::Periodic)
+				{
+					cell[axis] = (cell[axis] % cells + cells) % cells;
+				}
+				else
+				{
+					cell[axis] = std::min(std::max<std::ptrdiff_t>(cell[axis], 0), cells - 1);
+				}
+			}
+		}
+
+		//point (padded index) of level's block index, read at the level's blend time while the next level subcycles
+		void blendedPoint(size_t level, size_t index, size_t point, Value& output) const
+		{
+			const Level& current = levels[level];
+			const T* data = current.blocks[index].local().getData() + point * components;
+			if (current.previous.empty())
+			{
+				std::copy(data, data + components, output.begin());
+				return;
+			}
+			const T* previous = current.previous[index].get() + point * components;
+			for (size_t c = 0; c < components; ++c)
+			{
+				output[c] = previous[c] + T(current.blend) * (data[c] - previous[c]);
+			}
+		}
+
+		//the value of a cell of level, from the block holding it or else interpolated from the level below
+		void levelValue(size_t level, Cell cell, Value& output) const
+		{
+			wrap(level, cell);
+			const Level& current = levels[level];
+			Position position, inside;
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				position[axis] = (size_t)cell[axis] / blockSize;
+				inside[axis] = (size_t)cell[axis] % blockSize;
+			}
+			auto found = current.lookup.find(position);
+			if (found == current.lookup.end())
+			{
+				prolong(level, cell, output);
+				return;
+			}
+			blendedPoint(level, found->second, current.blocks[found->second].paddedPoint(inside), output);
+		}
+
+		//linear interpolation of a level cell from its parent with minmod limited slopes,
+		//so the 2^dimensions children of a cell average to its value
+		void prolong(size_t level, const Cell& cell, Value& output) const
+		{
+			Cell parent;
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				parent[axis] = cell[axis] / 2;
+			}
+			levelValue(level - 1, parent, output);
+			Value centre = output;
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				Value below, above;
+				Cell neighbour = parent;
+				--neighbour[axis];
+				levelValue(level - 1, neighbour, below);
+				neighbour[axis] += 2;
+				levelValue(level - 1, neighbour, above);
+				T offset = cell[axis] % 2 ? T(0.25) : T(-0.25);
+				for (size_t c = 0; c < components; ++c)
+				{
+					output[c] += offset * minmod(above[c] - centre[c], centre[c] - below[c]);
+				}
+			}
+		}
+
+		//sets the points from low to high (padded positions, high excluded) of level's block index by the
+		//same interpolation as prolong, from the block of level - 1 holding its parents and that block's ghosts
+		void prolongBox(size_t level, size_t index, const Position& low, const Position& high)
+		{
+			Level& fine = levels[level];
+			const Position& position = fine.positions[index];
+			Position parentPosition, extents;
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				parentPosition[axis] = position[axis] / 2;
+				extents[axis] = high[axis] - low[axis];
+			}
+			size_t parent = levels[level - 1].lookup.at(parentPosition);
+			const DynamicExtents<dimensions>& parentGrid = levels[level - 1].blocks[parent].local().getGrid();
+			const DynamicExtents<dimensions>& grid = fine.blocks[index].local().getGrid();
+			T* data = fine.blocks[index].local().getData();
+			size_t count = std::accumulate(extents.begin(), extents.end(), size_t(1), std::multiplies<size_t>());
+			for (size_t n = 0; n < count; ++n)
+			{
+				size_t point = 0, parentPoint = 0;
+				Position parentPadded;
+				std::array<bool, dimensions> odd;
+				for (size_t axis = dimensions, rest = n; axis > 0; --axis)
+				{
+					size_t padded = low[axis - 1] + rest % extents[axis - 1];
+					rest /= extents[axis - 1];
+					//from the first fine cell of the parent block, shifted by 2 * ghosts to stay positive
+					size_t shifted = position[axis - 1] % 2 * blockSize + padded + ghosts;
+					parentPadded[axis - 1] = shifted / 2;
+					odd[axis - 1] = shifted % 2 == 1;
+					point += padded * grid.stride(axis - 1);
+					parentPoint += parentPadded[axis - 1] * parentGrid.stride(axis - 1);
+				}
+				Value centre, below, above;
+				blendedPoint(level - 1, parent, parentPoint, centre);
+				T* output = data + point * components;
+				std::copy(centre.begin(), centre.end(), output);
+				for (size_t axis = 0; axis < dimensions; ++axis)
+				{
+					size_t stride = parentGrid.stride(axis);
+					//past the parent's ghosts the slope is left out
+					if (parentPadded[axis] == 0 || parentPadded[axis] + 1 == parentGrid.extents[axis])
+					{
+						continue;
+					}
+					blendedPoint(level - 1, parent, parentPoint - stride, below);
+					blendedPoint(level - 1, parent, parentPoint + stride, above);
+					T offset = odd[axis] ? T(0.25) : T(-0.25);
+					for (size_t c = 0; c < components; ++c)
+					{
+						output[c] += offset * minmod(above[c] - centre[c], centre[c] - below[c]);
+					}
+				}
+			}
+		}
+
+		//the ghosts of level's block index facing each of its 3^dimensions - 1 neighbours are copied row by row
+		//from the neighbour's interior, or interpolated from the level below where the neighbour is not on level
+		//(edges and corners included). ghosts on the domain boundary are set afterwards from the boundary
+		//conditions, taken at the cell faces, over the whole padded extent of the other axes.
+		void fillBlockGhosts(size_t level, size_t index)
+		{
+			Level& current = levels[level];
+			Block& block = current.blocks[index];
+			const Position& position = current.positions[index];
+			const DynamicExtents<dimensions>& grid = block.local().getGrid();
+			T* data = block.local().getData();
+			forNeighbours(level, position, [&](const Position& neighbour, const Position& step)
+			{
+				Position low, high;
+				std::ptrdiff_t shift = 0;
+				bool self = true;
+				for (size_t axis = 0; axis < dimensions; ++axis)
+				{
+					self &= step[axis] == 1;
+					low[axis] = step[axis] == 0 ? 0 : step[axis] == 1 ? ghosts : ghosts + blockSize;
+					high[axis] = step[axis] == 0 ? ghosts : step[axis] == 1 ? ghosts + blockSize : blockSize + 2 * ghosts;
+					shift += (1 - (std::ptrdiff_t)step[axis]) * (std::ptrdiff_t)(blockSize * grid.stride(axis));
+				}
+				if (self)
+				{
+					return;
+				}
+				auto found = current.lookup.find(neighbour);
+				if (found == current.lookup.end())
+				{
+					prolongBox(level, index, low, high);
+					return;
+				}
+				const T* source = current.blocks[found->second].local().getData();
+				size_t rowLength = (high[dimensions - 1] - low[dimensions - 1]) * components;
+				size_t rows = 1;
+				for (size_t axis = 0; axis + 1 < dimensions; ++axis)
+				{
+					rows *= high[axis] - low[axis];
+				}
+				for (size_t row = 0; row < rows; ++row)
+				{
+					size_t point = low[dimensions - 1];
+					for (size_t axis = dimensions - 1, rest = row; axis > 0; --axis)
+					{
+						point += (low[axis - 1] + rest % (high[axis - 1] - low[axis - 1])) * grid.stride(axis - 1);
+						rest /= high[axis - 1] - low[axis - 1];
+					}
+					const T* start = source + ((std::ptrdiff_t)point + shift) * (std::ptrdiff_t)components;
+					std::copy(start, start + rowLength, data + point * components);
+				}
+			});
+
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				for (size_t side = 0; side < 2; ++side)
+				{
+					GhostBoundary<T> boundary = boundaries[axis][side].atFace();
+					bool edge = side == 0 ? position[axis] == 0 : position[axis] + 1 == levelBlocks(level, axis);
+					if (!edge || boundary.condition == GhostCondition::Periodic)
+					{
+						boundary = GhostBoundary<T>::external();
+					}
+					else if (boundary.condition == GhostCondition::Neumann)
+					{
+						//the value is given for the level 0 spacing
+						boundary.value /= T(size_t(1) << level);
+					}
+					block.setBoundary(axis, side, boundary);
+				}
+			}
+			block.fillGhosts();
+		}
+
+		void fillLevelGhosts(size_t level)
+		{
+			parallelFor(levels[level].blocks.size(), [&](size_t begin, size_t end)
+			{
+				for (size_t index = begin; index < end; ++index)
+				{
+					fillBlockGhosts(level, index);
+				}
+			});
+		}
+
+		//sets the interior of level's block index by interpolating from the level below (its ghosts filled)
+		void prolongBlock(size_t level, size_t index)
+		{
+			Position low, high;
+			low.fill(ghosts);
+			high.fill(ghosts + blockSize);
+			prolongBox(level, index, low, high);
+		}
+
+		//replaces the cells of level - 1 covered by level with the average of their children
+		void averageDown(size_t level)
+		{
+			Level& fine = levels[level];
+			Level& coarse = levels[level - 1];
+			constexpr size_t half = blockSize / 2;
+			constexpr size_t children = Template_Power<2, dimensions>::value;
+			parallelFor(fine.blocks.size(), [&](size_t begin, size_t end)
+			{
+				for (size_t index = begin; index < end; ++index)
+				{
+					const Block& block = fine.blocks[index];
+					Position parentPosition, offset;
+					for (size_t axis = 0; axis < dimensions; ++axis)
+					{
+						parentPosition[axis] = fine.positions[index][axis] / 2;
+						offset[axis] = fine.positions[index][axis] % 2 * half;
+					}
+					Block& parent = coarse.blocks[coarse.lookup.at(parentPosition)];
+					for (size_t point = 0; point < Template_Power<half, dimensions>::value; ++point)
+					{
+						Position coarseCell = unflatten(point, half);
+						Value sum = {};
+						for (size_t child = 0; child < children; ++child)
+						{
+							Position fineCell = unflatten(child, 2);
+							for (size_t axis = 0; axis < dimensions; ++axis)
+							{
+								fineCell[axis] += 2 * coarseCell[axis];
+							}
+							const T* data = block.local().getData() + block.paddedPoint(fineCell) * components;
+							for (size_t c = 0; c < components; ++c)
+							{
+								sum[c] += data[c];
+							}
+						}
+						for (size_t axis = 0; axis < dimensions; ++axis)
+						{
+							coarseCell[axis] += offset[axis];
+						}
+						T* output = parent.local().getData() + parent.paddedPoint(coarseCell) * components;
+						for (size_t c = 0; c < components; ++c)
+						{
+							output[c] = sum[c] / T(children);
+						}
+					}
+				}
+			});
+		}
+
+		//calls visit(neighbour, step) for the 3^dimensions blocks around position on level (itself included),
+		//wrapped through periodic sides and skipping those outside the domain. step is the neighbour's
+		//offset plus one along each axis
+		template<typename Visit>
+		void forNeighbours(size_t level, const Position& position, Visit&& visit) const
+		{
+			for (size_t shift = 0; shift < Template_Power<3, dimensions>::value; ++shift)
+			{
+				Position step = unflatten(shift, 3);
+				Cell neighbour;
+				bool inside = true;
+				for (size_t axis = 0; axis < dimensions; ++axis)
+				{
+					std::ptrdiff_t blocks = (std::ptrdiff_t)levelBlocks(level, axis);
+					neighbour[axis] = (std::ptrdiff_t)position[axis] + (std::ptrdiff_t)step[axis] - 1;
+					if (neighbour[axis] < 0 || neighbour[axis] >= blocks)
+					{
+						inside &= boundaries[axis][neighbour[axis] < 0 ? 0 : 1].condition == GhostCondition::Periodic;
+						neighbour[axis] = (neighbour[axis] + blocks) % blocks;
+					}
+				}
+				if (inside)
+				{
+					Position output;
+					std::copy(neighbour.begin(), neighbour.end(), output.begin());
+					visit((const Position&)output, (const Position&)step);
+				}
+			}
+		}
+
+		template<typename Step>
+		void advanceLevel(size_t level, double dt, Step& step)
+		{
+			Level& current = levels[level];
+			bool finer = level + 1 < levels.size();
+			fillLevelGhosts(level);
+			if (finer)
+			{
+				current.previous.resize(current.blocks.size());
+				for (size_t index = 0; index < current.blocks.size(); ++index)
+				{
+					const DynamicTensorField<dimensions, rank, T>& data = current.blocks[index].local();
+					size_t scalars = data.size() * components;
+					current.previous[index] = pooledArray<T>(scalars, false);
+					std::copy(data.getData(), data.getData() + scalars, current.previous[index].get());
+				}
+			}
+			std::array<double, dimensions> levelSpacing = uniformSpacing<dimensions>(spacing(level));
+			parallelFor(current.blocks.size(), [&](size_t begin, size_t end)
+			{
+				for (size_t index = begin; index < end; ++index)
+				{
+					step(level, current.blocks[index], dt, levelSpacing);
+				}
+			});
+			if (finer)
+			{
+				//the ghosts again at the end of the step, which the next level's second half step
+				//interpolates towards (the level below is then read half of its step later)
+				if (level > 0)
+				{
+					levels[level - 1].blend += 0.5;
+				}
+				fillLevelGhosts(level);
+				if (level > 0)
+				{
+					levels[level - 1].blend -= 0.5;
+				}
+				for (size_t substep = 0; substep < 2; ++substep)
+				{
+					current.blend = 0.5 * substep;
+					advanceLevel(level + 1, dt / 2, step);
+				}
+				current.blend = 1;
+				current.previous.clear();
+				averageDown(level + 1);
+			}
+		}
+	public:
+		//baseBlocks is the number of level 0 blocks along each axis, baseSpacing the level 0 cell size.
+		//at most maxLevels levels are made (1 keeps the uniform level 0). every side starts out periodic.
+		AdaptiveTensorField(const Position& initBaseBlocks, double initBaseSpacing, size_t initMaxLevels)
+		:
+			baseBlocks(initBaseBlocks),
+			baseSpacing(initBaseSpacing),
+			maxLevels(std::max<size_t>(initMaxLevels, 1)),
+			levels(1)
+		{
+			setBoundary(GhostBoundary<T>::periodic());
+			size_t count = std::accumulate(baseBlocks.begin(), baseBlocks.end(), size_t(1), std::multiplies<size_t>());
+			for (size_t block = 0; block < count; ++block)
+			{
+				Position position;
+				for (size_t axis = dimensions, rest = block; axis > 0; --axis)
+				{
+					position[axis - 1] = rest % baseBlocks[axis - 1];
+					rest /= baseBlocks[axis - 1];
+				}
+				levels[0].add(position);
+			}
+		}
+
+		//side 0 is the start of axis, side 1 the end. the boundary is at the cell faces (whatever the
+		//boundary's centring), neumann values are the derivative times the level 0 spacing.
+		void setBoundary(size_t axis, size_t side, const GhostBoundary<T>& boundary)
+		{
+			boundaries[axis][side] = boundary;
+		}
+
+		void setBoundary(const GhostBoundary<T>& boundary)
+		{
+			for (auto& axisBoundaries : boundaries)
+			{
+				axisBoundaries.fill(boundary);
+			}
+		}
+
+		size_t levelCount() const
+		{
+			return levels.size();
+		}
+
+		size_t blockCount(size_t level) const
+		{
+			return levels[level].blocks.size();
+		}
+
+		Block& block(size_t level, size_t index)
+		{
+			return levels[level].blocks[index];
+		}
+
+		const Block& block(size_t level, size_t index) const
+		{
+			return levels[level].blocks[index];
+		}
+
+		//in blocks of the level, the first cell of the block is blockPosition * blockSize
+		const Position& blockPosition(size_t level, size_t index) const
+		{
+			return levels[level].positions[index];
+		}
+
+		double spacing(size_t level) const
+		{
+			return baseSpacing / double(size_t(1) << level);
+		}
+
+		//interior cells over every level
+		size_t cellCount() const
+		{
+			size_t output = 0;
+			for (const Level& level : levels)
+			{
+				output += level.blocks.size() * blockCells;
+			}
+			return output;
+		}
+
+		//sets every interior cell of every level to initial(centre), centre being the cell's position
+		//(std::array<double, dimensions>) and the result a Tensor<dimensions, rank, T>
+		template<typename Initial>
+		void initialize(Initial&& initial)
+		{
+			for (size_t level = 0; level < levels.size(); ++level)
+			{
+				Level& current = levels[level];
+				double h = spacing(level);
+				parallelFor(current.blocks.size(), [&](size_t begin, size_t end)
+				{
+					for (size_t index = begin; index < end; ++index)
+					{
+						for (size_t point = 0; point < blockCells; ++point)
+						{
+							Position inside = unflatten(point, blockSize);
+							std::array<double, dimensions> centre;
+							for (size_t axis = 0; axis < dimensions; ++axis)
+							{
+								centre[axis] = (double(current.positions[index][axis] * blockSize + inside[axis]) + 0.5) * h;
+							}
+							Tensor<dimensions, rank, T> value = initial(centre);
+							std::copy(value.getData(), value.getData() + components,
+								current.blocks[index].local().getData() + current.blocks[index].paddedPoint(inside) * components);
+						}
+					}
+				});
+			}
+		}
+
+		//fills the ghost cells of every block, coarsest level first
+		void fillGhosts()
+		{
+			for (size_t level = 0; level < levels.size(); ++level)
+			{
+				fillLevelGhosts(level);
+			}
+		}
+
+		//makes every covered coarse cell the average of its children, finest level first
+		void averageDown()
+		{
+			for (size_t level = levels.size(); level > 1; --level)
+			{
+				averageDown(level - 1);
+			}
+		}
+
+		//rebuilds the levels above 0. refine(level, block, spacing) is called for every block (ghosts
+		//filled, spacing a std::array<double, dimensions>) and returns true where the next level is wanted.
+		//a flagged block and its neighbours are refined, then the coarser levels are refined as far as
+		//proper nesting needs. at most one level is added per call. blocks that stay keep their data,
+		//new ones are interpolated from the level below, the coarse levels are averaged down at the end.
+		template<typename Criterion>
+		void regrid(Criterion&& refine)
+		{
+			fillGhosts();
+			size_t top = std::min(levels.size(), maxLevels - 1);
+			std::vector<std::set<Position>> chosen(top);
+			for (size_t level = 0; level < top; ++level)
+			{
+				const Level& current = levels[level];
+				std::array<double, dimensions> levelSpacing = uniformSpacing<dimensions>(spacing(level));
+				std::vector<char> flags(current.blocks.size());
+				parallelFor(current.blocks.size(), [&](size_t begin, size_t end)
+				{
+					for (size_t index = begin; index < end; ++index)
+					{
+						flags[index] = refine(level, (const Block&)current.blocks[index], (const std::array<double, dimensions>&)levelSpacing);
+					}
+				});
+				for (size_t index = 0; index < current.blocks.size(); ++index)
+				{
+					if (flags[index])
+					{
+						forNeighbours(level, current.positions[index], [&](const Position& neighbour, const Position&)
+						{
+							if (current.lookup.count(neighbour))
+							{
+								chosen[level].insert(neighbour);
+							}
+						});
+					}
+				}
+			}
+
+			//the neighbours of a refined block have to be on its level, so their parents are refined too
+			for (size_t level = top; level > 1; --level)
+			{
+				for (const Position& position : chosen[level - 1])
+				{
+					forNeighbours(level - 1, position, [&](const Position& neighbour, const Position&)
+					{
+						Position parent;
+						for (size_t axis = 0; axis < dimensions; ++axis)
+						{
+							parent[axis] = neighbour[axis] / 2;
+						}
+						chosen[level - 2].insert(parent);
+					});
+				}
+			}
+
+			for (size_t level = 1; level <= top; ++level)
+			{
+				if (chosen[level - 1].empty())
+				{
+					levels.resize(level);
+					break;
+				}
+				Level next;
+				std::vector<size_t> fresh;
+				for (const Position& parent : chosen[level - 1])
+				{
+					for (size_t child = 0; child < Template_Power<2, dimensions>::value; ++child)
+					{
+						Position position = unflatten(child, 2);
+						for (size_t axis = 0; axis < dimensions; ++axis)
+						{
+							position[axis] += 2 * parent[axis];
+						}
+						next.add(position);
+						bool kept = false;
+						if (level < levels.size())
+						{
+							auto old = levels[level].lookup.find(position);
+							if (old != levels[level].lookup.end())
+							{
+								next.blocks.back() = std::move(levels[level].blocks[old->second]);
+								kept = true;
+							}
+						}
+						if (!kept)
+						{
+							fresh.push_back(next.blocks.size() - 1);
+						}
+					}
+				}
+				if (level == levels.size())
+				{
+					levels.emplace_back();
+				}
+				levels[level] = std::move(next);
+				fillLevelGhosts(level - 1);
+				parallelFor(fresh.size(), [&](size_t begin, size_t end)
+				{
+					for (size_t index = begin; index < end; ++index)
+					{
+						prolongBlock(level, fresh[index]);
+					}
+				});
+			}
+			averageDown();
+		}
+
+		//regrid where a block's largest change between neighbouring cells (second order gradient
+		//times spacing, over every component) is above threshold
+		void regridByGradient(double threshold)
+		{
+			regrid([threshold](size_t, const Block& block, const std::array<double, dimensions>& levelSpacing)
+			{
+				return double(normLInf(gradient<2>(block, levelSpacing).local())) * levelSpacing[0] > threshold;
+			});
+		}
+
+		//advances every level by dt, the level 0 step, with subcycling: level l takes 2^l steps of dt / 2^l.
+		//step(level, block, dt, spacing) advances one block in place and is called with its ghosts filled
+		//(for all blocks of a level at once, on the parallel execution threads). a level steps first,
+		//then the next one takes its two half steps with coarse-fine ghosts interpolated in time between
+		//the coarse values before and after, and is then averaged down onto it.
+		template<typename Step>
+		void advance(double dt, Step&& step)
+		{
+			advanceLevel(0, dt, step);
+		}
+
+		//every cell of level as one field, from the blocks of level where there are any and
+		//interpolated from the levels below elsewhere
+		DynamicTensorField<dimensions, rank, T> uniformField(size_t level) const
+		{
+			Position extents;
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				extents[axis] = levelBlocks(level, axis) * blockSize;
+			}
+			DynamicTensorField<dimensions, rank, T> output{DynamicExtents<dimensions>(extents)};
+			const DynamicExtents<dimensions>& grid = output.getGrid();
+			T* data = output.getData();
+			parallelFor(grid.points, [&](size_t begin, size_t end)
+			{
+				for (size_t point = begin; point < end; ++point)
+				{
+					Cell cell;
+					for (size_t axis = 0; axis < dimensions; ++axis)
+					{
+						cell[axis] = (std::ptrdiff_t)(point / grid.stride(axis) % grid.extents[axis]);
+					}
+					Value value;
+					levelValue(level, cell, value);
+					std::copy(value.begin(), value.end(), data + point * components);
+				}
+			});
+			return output;
+		}
+	};
+
+}
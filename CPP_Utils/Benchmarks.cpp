@@ -0,0 +1,419 @@
+//micro-benchmarks for tensor expressions, field expressions and gradients.
+//
+//build and run (from this directory):
+//	g++ -std=c++17 -O3 -march=native -pthread Benchmarks.cpp -o benchmarks
+//	./benchmarks [--threads n] [--quick] [--output results.json]
+//
+//every benchmark reports its best time per evaluation, the GB/s and GFLOP/s that implies
+//(counting the bytes each evaluation has to read and write, and its arithmetic) and, for the
+//kernels over whole fields, the fraction of a STREAM triad measured at the start of the run.
+//results are written as JSON so runs on different commits can be compared.
+
+#include "VectorSpace.h"
+#include <sstream>
+#include <limits>
+
+using namespace SimulationUtilities;
+
+namespace
+{
+	struct BenchmarkResult
+	{
+		std::string group;
+		std::string name;
+		size_t dimensions;
+		size_t rank;
+		size_t points;
+		double seconds;//per evaluation
+		double bytes;//per evaluation
+		double flops;//per evaluation
+		bool streaming;//runs over fields beyond the caches, so the STREAM triad is a fair comparison
+	};
+
+	struct BenchmarkSettings
+	{
+		double minimumSeconds = 0.2;
+		size_t repetitions = 3;
+		bool quick = false;
+		//set while benchmarks run on the largest fields
+		bool streaming = false;
+		std::vector<BenchmarkResult> results;
+	};
+
+	BenchmarkSettings settings;
+
+	//keeps the compiler from removing work whose result is never read
+	inline void escape(const void* pointer)
+	{
+#if defined(__GNUC__)
+		asm volatile("" : : "g"(pointer) : "memory");
+#else
+		static const void* volatile sink;
+		sink = pointer;
+#endif
+	}
+
+	//best (over repetitions) average time of body, each repetition runs for at least minimumSeconds
+	template<typename Body>
+	double timeBest(const Body& body)
+	{
+		typedef std::chrono::steady_clock Clock;
+		double best = std::numeric_limits<double>::max();
+		body();
+		for (size_t repetition = 0; repetition < settings.repetitions; ++repetition)
+		{
+			size_t iterations = 0;
+			Clock::time_point start = Clock::now();
+			double elapsed;
+			do
+			{
+				body();
+				++iterations;
+				elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+			} while (elapsed < settings.minimumSeconds);
+			best = std::min(best, elapsed / iterations);
+		}
+		return best;
+	}
+
+	template<typename Body>
+	void record(const std::string& group, const std::string& name, size_t dimensions, size_t rank, size_t points,
+		double bytes, double flops, const Body& body)
+	{
+		double seconds = timeBest(body);
+		settings.results.push_back({group, name, dimensions, rank, points, seconds, bytes, flops, settings.streaming});
+		std::cerr << group << " " << name << " d" << dimensions << " r" << rank << " n" << points
+			<< ": " << bytes / seconds * 1e-9 << " GB/s " << flops / seconds * 1e-9 << " GFLOP/s" << std::endl;
+	}
+
+	//STREAM triad a = b + s * c over arrays well beyond the last level cache
+	double streamTriad()
+	{
+		size_t count = settings.quick ? (size_t(1) << 22) : (size_t(1) << 24);
+		std::vector<double> a(count, 0), b(count, 1), c(count, 2);
+		double scale = 3;
+		double* aData = a.data();
+		const double* bData = b.data();
+		const double* cData = c.data();
+		double seconds = timeBest([&]
+		{
+			parallelFor(count, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					aData[i] = bData[i] + scale * cData[i];
+				}
+			});
+			escape(aData);
+		});
+		double gigabytes = 3.0 * sizeof(double) * count * 1e-9;
+		std::cerr << "stream triad: " << gigabytes / seconds << " GB/s" << std::endl;
+		return gigabytes / seconds;
+	}
+
+	template<typename Indexable, size_t... Is>
+	auto indexed(const Indexable& input, std::index_sequence<Is...>)
+	{
+		return input(Index<char('a' + Is)>()...);
+	}
+
+	template<typename TensorType>
+	void fill(TensorType& input, double seed)
+	{
+		double* data = input.getData();
+		for (size_t i = 0; i < sizeof(TensorType) / sizeof(double); ++i)
+		{
+			data[i] = seed + 0.001 * i;
+		}
+	}
+
+	//C = A + B * s on single tensors, evaluated many times per timing call
+	template<size_t dimensions, size_t rank>
+	void tensorArithmetic()
+	{
+		constexpr size_t components = Template_Power<dimensions, rank>::value;
+		constexpr size_t evaluations = 1024;
+		Tensor<dimensions, rank> A, B, C;
+		fill(A, 1);
+		fill(B, 2);
+		auto seq = std::make_index_sequence<rank>();
+		record("tensor", "A+B*s", dimensions, rank, 1, 3.0 * components * sizeof(double), 2.0 * components, [&]
+		{
+			for (size_t i = 0; i < evaluations; ++i)
+			{
+				indexed(C, seq) = indexed(A, seq) + indexed(B, seq) * 1.0001;
+				escape(&C);
+			}
+		});
+		settings.results.back().seconds /= evaluations;
+	}
+
+	template<size_t dimensions>
+	void tensorContractions()
+	{
+		constexpr size_t evaluations = 1024;
+		constexpr double d = dimensions;
+		Index<'i'> i;
+		Index<'j'> j;
+		Index<'k'> k;
+		Tensor<dimensions, 2> A, B, C;
+		Tensor<dimensions, 1> v, w;
+		Tensor<dimensions, 0> s;
+		fill(A, 1);
+		fill(B, 2);
+		fill(v, 3);
+
+		record("contraction", "A(i,j)*v(j)", dimensions, 2, 1, (d * d + 2 * d) * sizeof(double), 2 * d * d, [&]
+		{
+			for (size_t n = 0; n < evaluations; ++n)
+			{
+				w(i) = A(i, j) * v(j);
+				escape(&w);
+			}
+		});
+		settings.results.back().seconds /= evaluations;
+
+		record("contraction", "A(i,i)", dimensions, 2, 1, (d * d + 1) * sizeof(double), d, [&]
+		{
+			for (size_t n = 0; n < evaluations; ++n)
+			{
+				s() = A(i, i);
+				escape(&s);
+			}
+		});
+		settings.results.back().seconds /= evaluations;
+
+		record("contraction", "A(i,j)*B(j,k)", dimensions, 2, 1, 3 * d * d * sizeof(double), 2 * d * d * d, [&]
+		{
+			for (size_t n = 0; n < evaluations; ++n)
+			{
+				C(i, k) = A(i, j) * B(j, k);
+				escape(&C);
+			}
+		});
+		settings.results.back().seconds /= evaluations;
+	}
+
+	//grids holding about scalars values in total (at least 5 points per axis)
+	template<size_t dimensions, size_t rank>
+	DynamicExtents<dimensions> benchmarkGrid(size_t scalars)
+	{
+		size_t points = std::max<size_t>(scalars / Template_Power<dimensions, rank>::value, 1);
+		size_t extent = std::max<size_t>(std::lround(std::pow(points, 1.0 / dimensions)), 5);
+		std::array<size_t, dimensions> extents;
+		extents.fill(extent);
+		return DynamicExtents<dimensions>(extents);
+	}
+
+	std::vector<size_t> fieldSizes()
+	{
+		//about L2, last level cache and main memory sized fields (the last one is compared with the STREAM triad)
+		if (settings.quick)
+		{
+			return {size_t(1) << 15, size_t(1) << 20};
+		}
+		return {size_t(1) << 15, size_t(1) << 20, size_t(1) << 23};
+	}
+
+	template<size_t dimensions, size_t rank>
+	void fieldExpressions()
+	{
+		constexpr size_t components = Template_Power<dimensions, rank>::value;
+		for (size_t scalars : fieldSizes())
+		{
+			settings.streaming = scalars == fieldSizes().back();
+			DynamicExtents<dimensions> grid = benchmarkGrid<dimensions, rank>(scalars);
+			DynamicTensorField<dimensions, rank> A(grid), B(grid), C(grid);
+			for (size_t i = 0; i < A.size() * components; ++i)
+			{
+				A.getData()[i] = 1 + 0.001 * i;
+				B.getData()[i] = 2 - 0.001 * i;
+			}
+			double values = (double)grid.points * components;
+			auto seq = std::make_index_sequence<rank>();
+
+			record("field", "C=A+B*s", dimensions, rank, grid.points, 3 * values * sizeof(double), 2 * values, [&]
+			{
+				indexed(C, seq) = indexed(A, seq) + indexed(B, seq) * 1.0001;
+				escape(C.getData());
+			});
+
+			record("field", "C+=A", dimensions, rank, grid.points, 3 * values * sizeof(double), values, [&]
+			{
+				C += A;
+				escape(C.getData());
+			});
+		}
+		settings.streaming = false;
+	}
+
+	//the stencil engine the gradient functions use, writing into output so its allocation is not timed
+	template<bool periodic, size_t dimensions, size_t rank>
+	void gradientInto(const DynamicTensorField<dimensions, rank>& input, DynamicTensorField<dimensions, rank + 1>& output)
+	{
+		std::array<double, dimensions> spacing;
+		spacing.fill(0.1);
+		GradientStencilEngine<dimensions, Template_Power<dimensions, rank>::value, double, FourthOrderFirstDerivative, periodic>
+			(input.getGrid().extents, spacing.data()).apply(input.getData(), output.getData());
+	}
+
+	template<size_t dimensions, size_t rank>
+	void gradientBenchmarks()
+	{
+		constexpr size_t components = Template_Power<dimensions, rank>::value;
+		for (size_t scalars : fieldSizes())
+		{
+			settings.streaming = scalars == fieldSizes().back();
+			DynamicExtents<dimensions> grid = benchmarkGrid<dimensions, rank>(scalars);
+			DynamicTensorField<dimensions, rank> A(grid);
+			DynamicTensorField<dimensions, rank + 1> output(grid);
+			for (size_t i = 0; i < A.size() * components; ++i)
+			{
+				A.getData()[i] = std::sin(0.01 * i);
+			}
+			double values = (double)grid.points * components;
+			//reads the input once and writes one output per axis, 5 multiplies, 4 adds and a scale each
+			double bytes = (1 + dimensions) * values * sizeof(double);
+			double flops = dimensions * values * 10;
+			auto seq = std::make_index_sequence<rank + 1>();
+
+			record("gradient", "ignoreBoundary", dimensions, rank, grid.points, bytes, flops, [&]
+			{
+				gradientInto<false>(A, output);
+				escape(output.getData());
+			});
+
+			record("gradient", "periodicBoundary", dimensions, rank, grid.points, bytes, flops, [&]
+			{
+				gradientInto<true>(A, output);
+				escape(output.getData());
+			});
+
+			//the same stencil on one thread, to show what the tiles shared over the threads gain
+			size_t threads = parallelThreadCount();
+			if (threads > 1)
+			{
+				double parallelSeconds = settings.results.back().seconds;
+				setParallelExecution(1);
+				record("gradient", "periodicBoundary serial", dimensions, rank, grid.points, bytes, flops, [&]
+				{
+					gradientInto<true>(A, output);
+					escape(output.getData());
+				});
+				setParallelExecution(threads);
+				std::cerr << "gradient speedup on " << threads << " threads: "
+					<< settings.results.back().seconds / parallelSeconds << std::endl;
+			}
+
+			//the whole gradient through the lazy expression, one field expression sweep
+			auto lazyIgnore = lazyGradient_ignoreBoundary(A, 0.1);
+			record("gradient", "lazy ignoreBoundary", dimensions, rank, grid.points, bytes, flops, [&]
+			{
+				indexed(output, seq) = indexed(lazyIgnore, seq);
+				escape(output.getData());
+			});
+
+			auto lazyPeriodic = lazyGradient_periodicBoundary(A, 0.1);
+			record("gradient", "lazy periodicBoundary", dimensions, rank, grid.points, bytes, flops, [&]
+			{
+				indexed(output, seq) = indexed(lazyPeriodic, seq);
+				escape(output.getData());
+			});
+		}
+		settings.streaming = false;
+	}
+
+	//gradients of rank 3 fields would be rank 4, which the rank 0-3 range leaves out
+	template<size_t dimensions, size_t rank>
+	void gradients()
+	{
+		if constexpr (rank < 3)
+		{
+			gradientBenchmarks<dimensions, rank>();
+		}
+	}
+
+	template<size_t dimensions, size_t... ranks>
+	void benchmarkDimension(std::index_sequence<ranks...>)
+	{
+		(tensorArithmetic<dimensions, ranks>(), ...);
+		tensorContractions<dimensions>();
+		(fieldExpressions<dimensions, ranks>(), ...);
+		(gradients<dimensions, ranks>(), ...);
+	}
+
+	std::string toJson(double streamGBs, size_t threads)
+	{
+		std::ostringstream os;
+		os.precision(6);
+		os << "{\n";
+		os << "\t\"threads\": " << threads << ",\n";
+		os << "\t\"simd_width\": " << SimdRegister<double>::width << ",\n";
+		os << "\t\"stream_triad_gbs\": " << streamGBs << ",\n";
+		os << "\t\"results\": [\n";
+		for (size_t i = 0; i < settings.results.size(); ++i)
+		{
+			const BenchmarkResult& result = settings.results[i];
+			double gbs = result.bytes / result.seconds * 1e-9;
+			os << "\t\t{\"group\": \"" << result.group << "\", \"name\": \"" << result.name << "\""
+				<< ", \"dimensions\": " << result.dimensions << ", \"rank\": " << result.rank
+				<< ", \"points\": " << result.points << ", \"seconds\": " << result.seconds
+				<< ", \"gbs\": " << gbs << ", \"gflops\": " << result.flops / result.seconds * 1e-9;
+			//single tensors and cache sized fields are not limited by memory bandwidth, a fraction of it means nothing for them
+			if (result.streaming)
+			{
+				os << ", \"stream_fraction\": " << gbs / streamGBs;
+			}
+			os << "}" << (i + 1 < settings.results.size() ? ",\n" : "\n");
+		}
+		os << "\t]\n}\n";
+		return os.str();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t threads = 1;
+	std::string outputPath;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		if (argument == "--threads" && i + 1 < argc)
+		{
+			threads = std::stoul(argv[++i]);
+		}
+		else if (argument == "--quick")
+		{
+			settings.quick = true;
+			settings.minimumSeconds = 0.02;
+			settings.repetitions = 2;
+		}
+		else if (argument == "--output" && i + 1 < argc)
+		{
+			outputPath = argv[++i];
+		}
+		else
+		{
+			std::cerr << "usage: " << argv[0] << " [--threads n] [--quick] [--output results.json]" << std::endl;
+			return 1;
+		}
+	}
+	setParallelExecution(threads);
+
+	double streamGBs = streamTriad();
+	auto ranks = std::make_index_sequence<4>();
+	benchmarkDimension<2>(ranks);
+	benchmarkDimension<3>(ranks);
+	benchmarkDimension<4>(ranks);
+
+	std::string json = toJson(streamGBs, parallelThreadCount());
+	if (outputPath.empty())
+	{
+		std::cout << json;
+	}
+	else
+	{
+		std::ofstream(outputPath) << json;
+	}
+	return 0;
+}
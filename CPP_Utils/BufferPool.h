@@ -0,0 +1,283 @@
+namespace SimulationUtilities{
+
+	//where a BufferPool gets memory from when it has no cached buffer of the right size.
+	//the default hands out 64 byte aligned blocks from operator new.
+	struct BufferAllocator
+	{
+		void* (*allocate)(size_t bytes);
+		void (*deallocate)(void* buffer, size_t bytes);
+	};
+
+	inline void* alignedAllocate(size_t bytes)
+	{
+		return ::operator new(bytes, std::align_val_t(64));
+	}
+
+	inline void alignedDeallocate(void* buffer, size_t)
+	{
+		::operator delete(buffer, std::align_val_t(64));
+	}
+
+	struct BufferPoolStatistics
+	{
+		size_t hits = 0;//requests served from a cached buffer
+		size_t misses = 0;//requests that had to go to the allocator
+		size_t bytesInUse = 0;//bytes currently handed out (rounded up to the size class)
+		size_t peakBytes = 0;//largest bytesInUse seen
+		size_t cachedBytes = 0;//bytes held in the free lists
+	};
+
+	//caches released buffers by size class and hands them back out, so fields that are
+	//made and dropped every time step reuse the same memory instead of going to the heap.
+	//size classes are 64 bytes and then four classes per power of two (at most 25% slack).
+	//at most cacheLimit bytes are kept cached, a released buffer that does not fit goes
+	//straight back to the allocator.
+	class BufferPool
+	{
+		static constexpr size_t minimumClassBytes = 64;
+
+		std::mutex lock;
+		std::vector<std::vector<void*>> freeBuffers;
+		BufferAllocator allocator{alignedAllocate, alignedDeallocate};
+		BufferPoolStatistics statistics;
+		size_t cacheLimit = size_t(1) << 30;
+
+		//size of the class after the one of classBytes
+		static size_t nextClass(size_t classBytes)
+		{
+			size_t power = minimumClassBytes;
+			while (power * 2 <= classBytes)
+			{
+				power *= 2;
+			}
+			return classBytes + power / 4;
+		}
+
+		//smallest class that fits bytes, as its index and its size
+		static size_t sizeClass(size_t bytes, size_t& classBytes)
+		{
+			size_t index = 0;
+			classBytes = minimumClassBytes;
+			while (classBytes < bytes)
+			{
+				classBytes = nextClass(classBytes);
+				++index;
+			}
+			return index;
+		}
+
+		void freeCached()
+		{
+			size_t classBytes = minimumClassBytes;
+			for (auto& buffers : freeBuffers)
+			{
+				for (void* buffer : buffers)
+				{
+					allocator.deallocate(buffer, classBytes);
+				}
+				buffers.clear();
+				classBytes = nextClass(classBytes);
+			}
+			statistics.cachedBytes = 0;
+		}
+	public:
+		BufferPool() = default;
+		BufferPool(const BufferPool& other) = delete;
+		BufferPool& operator=(const BufferPool& other) = delete;
+
+		~BufferPool()
+		{
+			freeCached();
+		}
+
+		void* acquire(size_t bytes)
+		{
+			size_t classBytes;
+			size_t index = sizeClass(bytes, classBytes);
+			std::lock_guard<std::mutex> guard(lock);
+			void* output;
+			if (index < freeBuffers.size() && !freeBuffers[index].empty())
+			{
+				output = freeBuffers[index].back();
+				freeBuffers[index].pop_back();
+				statistics.cachedBytes -= classBytes;
+				++statistics.hits;
+			}
+			else
+			{
+				output = allocator.allocate(classBytes);
+				++statistics.misses;
+			}
+			statistics.bytesInUse += classBytes;
+			statistics.peakBytes = std::max(statistics.peakBytes, statistics.bytesInUse);
+			return output;
+		}
+
+		//bytes must be the size the buffer was acquired with
+		void release(void* buffer, size_t bytes)
+		{
+			size_t classBytes;
+			size_t index = sizeClass(bytes, classBytes);
+			std::lock_guard<std::mutex> guard(lock);
+			statistics.bytesInUse -= classBytes;
+			if (statistics.cachedBytes + classBytes > cacheLimit)
+			{
+				allocator.deallocate(buffer, classBytes);
+				return;
+			}
+			if (index >= freeBuffers.size())
+			{
+				freeBuffers.resize(index + 1);
+			}
+			freeBuffers[index].push_back(buffer);
+			statistics.cachedBytes += classBytes;
+		}
+
+		//returns every cached buffer to the allocator
+		void trim()
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			freeCached();
+		}
+
+		//largest number of bytes kept in the free lists (1 GiB by default). lowering it
+		//frees every cached buffer, later releases only cache what fits under the limit.
+		void setCacheLimit(size_t bytes)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (bytes < cacheLimit)
+			{
+				freeCached();
+			}
+			cacheLimit = bytes;
+		}
+
+		//cached buffers are given back to the old allocator first. the allocator can only
+		//change while no buffer is in use (returns false and keeps the old one otherwise),
+		//since a buffer has to go back to the allocator it came from.
+		bool setAllocator(const BufferAllocator& newAllocator)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			if (statistics.bytesInUse != 0)
+			{
+				return false;
+			}
+			freeCached();
+			allocator = newAllocator;
+			return true;
+		}
+
+		BufferPoolStatistics getStatistics()
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			return statistics;
+		}
+
+		//zeroes hits, misses and peakBytes (peakBytes restarts from bytesInUse)
+		void resetStatistics()
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			statistics.hits = 0;
+			statistics.misses = 0;
+			statistics.peakBytes = statistics.bytesInUse;
+		}
+	};
+
+	//process wide pool selection (a named inline function, so there is one per program)
+	struct BufferPoolSettings
+	{
+		bool threadLocal = false;
+		std::shared_ptr<BufferPool> pool = std::make_shared<BufferPool>();
+	};
+
+	inline BufferPoolSettings& bufferPoolSettings()
+	{
+		static BufferPoolSettings settings;
+		return settings;
+	}
+
+	//allocator for the shared_ptr control blocks, so they come from the pool as well
+	template<typename U>
+	struct PoolControlAllocator
+	{
+		typedef U value_type;
+		std::shared_ptr<BufferPool> pool;
+
+		PoolControlAllocator(const std::shared_ptr<BufferPool>& initPool)
+		:
+			pool(initPool)
+		{}
+
+		template<typename Other>
+		PoolControlAllocator(const PoolControlAllocator<Other>& other)
+		:
+			pool(other.pool)
+		{}
+
+		U* allocate(size_t count)
+		{
+			return (U*)pool->acquire(count * sizeof(U));
+		}
+
+		void deallocate(U* buffer, size_t count)
+		{
+			pool->release(buffer, count * sizeof(U));
+		}
+
+		template<typename Other>
+		bool operator==(const PoolControlAllocator<Other>& other) const
+		{
+			return pool == other.pool;
+		}
+
+		template<typename Other>
+		bool operator!=(const PoolControlAllocator<Other>& other) const
+		{
+			return pool != other.pool;
+		}
+	};
+
+	//pool new field storage is taken from on the calling thread
+	inline const std::shared_ptr<BufferPool>& currentBufferPool()
+	{
+		BufferPoolSettings& settings = bufferPoolSettings();
+		if (settings.threadLocal)
+		{
+			thread_local std::shared_ptr<BufferPool> pool = std::make_shared<BufferPool>();
+			return pool;
+		}
+		return settings.pool;
+	}
+
+	//threadLocal = true gives every thread its own pool (no lock contention between threads
+	//making fields). a buffer always goes back to the pool it came from.
+	inline void setThreadLocalBufferPools(bool threadLocal)
+	{
+		bufferPoolSettings().threadLocal = threadLocal;
+	}
+
+	inline BufferPoolStatistics bufferPoolStatistics()
+	{
+		return currentBufferPool()->getStatistics();
+	}
+
+	//storage for count scalars from the current pool, zeroed if zero is set.
+	//the buffer goes back to the pool when the last shared_ptr to it is dropped.
+	template<typename T>
+	std::shared_ptr<T[]> pooledArray(size_t count, bool zero)
+	{
+		static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+			"pooled storage is only for plain scalar types.");
+		const std::shared_ptr<BufferPool>& pool = currentBufferPool();
+		size_t bytes = std::max<size_t>(count, 1) * sizeof(T);
+		T* data = (T*)pool->acquire(bytes);
+		if (zero)
+		{
+			std::fill(data, data + count, T());
+		}
+		std::shared_ptr<BufferPool> owner = pool;
+		return std::shared_ptr<T[]>(data, [owner, bytes](T* buffer){owner->release(buffer, bytes);},
+			PoolControlAllocator<T>(pool));
+	}
+
+}
@@ -0,0 +1,307 @@
+namespace SimulationUtilities{
+
+	//binary checkpoint layout (version 3, native byte order):
+	//	CheckpointFileHeader
+	//	CheckpointRecordHeader for every record
+	//	record data, each starting on a checkpointAlignment boundary
+	//a record is one TensorField or one plain value (double, Tensor, ...). a DirectSum is
+	//stored as its members' records in order, so a whole state is one file.
+	//record data is aligned to the page size so restarts can map it straight into fields.
+
+	static constexpr uint64_t checkpointAlignment = 4096;
+	static constexpr uint32_t checkpointVersion = 3;
+	static constexpr size_t checkpointMaxDimensions = 16;
+
+	struct CheckpointFileHeader
+	{
+		char magic[8];//"SUCHKPT" and a zero
+		uint32_t version;
+		uint32_t recordCount;
+	};
+
+	struct CheckpointRecordHeader
+	{
+		uint32_t kind;//0 TensorField, 1 plain value
+		uint32_t dimensions;
+		uint32_t rank;
+		uint32_t scalarBytes;//bytes per scalar (per value for plain records)
+		uint32_t scalarKind;//0 floating point, 1 integer, 2 other
+		uint32_t componentMajor;//1 for ComponentMajor layout
+		uint32_t symmetry;//0 none, 1 Symmetric, 2 Antisymmetric (packed components)
+		uint32_t leadingIndices;//indices before the (anti)symmetric ones
+		uint32_t pointOrder;//0 row major, 1 tiled, 2 Morton
+		uint32_t tile;//tile size of a tiled grid
+		uint64_t extents[checkpointMaxDimensions];
+		uint64_t dataOffset;//from the start of the file
+		uint64_t dataBytes;
+	};
+
+	namespace
+	{
+		//record header and where its data is, as collected before writing
+		struct CheckpointRecord
+		{
+			CheckpointRecordHeader header;
+			const void* data;
+		};
+
+		template<typename T>
+		uint32_t checkpointScalarKind()
+		{
+			return std::is_floating_point<T>::value ? 0 : std::is_integral<T>::value ? 1 : 2;
+		}
+
+		template<typename Symmetry>
+		struct Checkpoint_Symmetry
+		{
+			static constexpr uint32_t kind = Symmetry::antisymmetric ? 2 : 1;
+			static constexpr uint32_t leadingIndices = Symmetry::leadingIndices;
+		};
+
+		template<>
+		struct Checkpoint_Symmetry<NoSymmetry>
+		{
+			static constexpr uint32_t kind = 0;
+			static constexpr uint32_t leadingIndices = 0;
+		};
+
+		template<typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+		void collectCheckpointRecords(const GridTensorField<Grid, rank, T, Layout, Symmetry>& field, std::vector<CheckpointRecord>& records);
+
+		template<typename... VectorTypes>
+		void collectCheckpointRecords(const DirectSum<VectorTypes...>& state, std::vector<CheckpointRecord>& records);
+
+		template<typename Plain>
+		std::enable_if_t<std::is_trivially_copyable<Plain>::value>
+		collectCheckpointRecords(const Plain& value, std::vector<CheckpointRecord>& records);
+
+		template<typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+		bool restoreCheckpointRecords(GridTensorField<Grid, rank, T, Layout, Symmetry>& field, const std::shared_ptr<char>& mapping,
+			const CheckpointRecordHeader*& header);
+
+		template<typename... VectorTypes>
+		bool restoreCheckpointRecords(DirectSum<VectorTypes...>& state, const std::shared_ptr<char>& mapping,
+			const CheckpointRecordHeader*& header);
+
+		template<typename Plain>
+		std::enable_if_t<std::is_trivially_copyable<Plain>::value, bool>
+		restoreCheckpointRecords(Plain& value, const std::shared_ptr<char>& mapping,
+			const CheckpointRecordHeader*& header);
+
+		template<typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+		void collectCheckpointRecords(const GridTensorField<Grid, rank, T, Layout, Symmetry>& field, std::vector<CheckpointRecord>& records)
+		{
+			static_assert(Grid::dimensions <= checkpointMaxDimensions, "too many dimensions for a checkpoint.");
+			CheckpointRecordHeader header{};
+			header.kind = 0;
+			header.dimensions = Grid::dimensions;
+			header.rank = rank;
+			header.scalarBytes = sizeof(T);
+			header.scalarKind = checkpointScalarKind<T>();
+			header.componentMajor = Layout::componentMajor;
+			header.symmetry = Checkpoint_Symmetry<Symmetry>::kind;
+			header.leadingIndices = Checkpoint_Symmetry<Symmetry>::leadingIndices;
+			header.pointOrder = Grid::pointOrder;
+			header.tile = (uint32_t)Grid::tile;
+			for (size_t axis = 0; axis < Grid::dimensions; ++axis)
+			{
+				header.extents[axis] = field.getGrid().extents[axis];
+			}
+			header.dataBytes = field.size() * Symmetry_Storage<Grid::dimensions, rank, Symmetry>::components * sizeof(T);
+			records.push_back({header, field.getData()});
+		}
+
+		template<typename... VectorTypes, size_t... Is>
+		void collectDirectSumRecords(const DirectSum<VectorTypes...>& state, std::vector<CheckpointRecord>& records,
+			std::index_sequence<Is...>)
+		{
+			(collectCheckpointRecords(get<Is>(state), records), ...);
+		}
+
+		template<typename... VectorTypes>
+		void collectCheckpointRecords(const DirectSum<VectorTypes...>& state, std::vector<CheckpointRecord>& records)
+		{
+			collectDirectSumRecords(state, records, std::index_sequence_for<VectorTypes...>());
+		}
+
+		template<typename Plain>
+		std::enable_if_t<std::is_trivially_copyable<Plain>::value>
+		collectCheckpointRecords(const Plain& value, std::vector<CheckpointRecord>& records)
+		{
+			CheckpointRecordHeader header{};
+			header.kind = 1;
+			header.scalarBytes = sizeof(Plain);
+			header.scalarKind = checkpointScalarKind<Plain>();
+			header.dataBytes = sizeof(Plain);
+			records.push_back({header, &value});
+		}
+
+		//the field shares the mapping (no copy), the pages are read in as they are touched.
+		//the mapping is private, so changing the field never changes the file.
+		template<typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+		bool restoreCheckpointRecords(GridTensorField<Grid, rank, T, Layout, Symmetry>& field, const std::shared_ptr<char>& mapping,
+			const CheckpointRecordHeader*& header)
+		{
+			const CheckpointRecordHeader& record = *header++;
+			if (record.kind != 0 || record.dimensions != Grid::dimensions || record.rank != rank
+				|| record.scalarBytes != sizeof(T) || record.scalarKind != checkpointScalarKind<T>()
+				|| record.componentMajor != Layout::componentMajor || record.symmetry != Checkpoint_Symmetry<Symmetry>::kind
+				|| record.leadingIndices != Checkpoint_Symmetry<Symmetry>::leadingIndices
+				|| record.pointOrder != Grid::pointOrder || record.tile != Grid::tile)
+			{
+				return false;
+			}
+			Grid grid;
+			if constexpr (Grid::fixed)
+			{
+				for (size_t axis = 0; axis < Grid::dimensions; ++axis)
+				{
+					if (record.extents[axis] != Grid::extents[axis])
+					{
+						return false;
+					}
+				}
+			}
+			else
+			{
+				std::array<size_t, Grid::dimensions> extents;
+				std::copy(record.extents, record.extents + Grid::dimensions, extents.begin());
+				grid = Grid(extents);
+			}
+			if (record.dataBytes != grid.points * Symmetry_Storage<Grid::dimensions, rank, Symmetry>::components * sizeof(T))
+			{
+				return false;
+			}
+			field = GridTensorField<Grid, rank, T, Layout, Symmetry>(grid, std::shared_ptr<T[]>(mapping, (T*)(mapping.get() + record.dataOffset)));
+			return true;
+		}
+
+		template<typename... VectorTypes, size_t... Is>
+		bool restoreDirectSumRecords(DirectSum<VectorTypes...>& state, const std::shared_ptr<char>& mapping,
+			const CheckpointRecordHeader*& header, std::index_sequence<Is...>)
+		{
+			return (restoreCheckpointRecords(getReference<Is>(state), mapping, header) && ...);
+		}
+
+		template<typename... VectorTypes>
+		bool restoreCheckpointRecords(DirectSum<VectorTypes...>& state, const std::shared_ptr<char>& mapping,
+			const CheckpointRecordHeader*& header)
+		{
+			return restoreDirectSumRecords(state, mapping, header, std::index_sequence_for<VectorTypes...>());
+		}
+
+		template<typename Plain>
+		std::enable_if_t<std::is_trivially_copyable<Plain>::value, bool>
+		restoreCheckpointRecords(Plain& value, const std::shared_ptr<char>& mapping,
+			const CheckpointRecordHeader*& header)
+		{
+			const CheckpointRecordHeader& record = *header++;
+			if (record.kind != 1 || record.dataBytes != sizeof(Plain) || record.scalarKind != checkpointScalarKind<Plain>())
+			{
+				return false;
+			}
+			std::copy(mapping.get() + record.dataOffset, mapping.get() + record.dataOffset + sizeof(Plain), (char*)&value);
+			return true;
+		}
+
+		//fills in the data offsets and writes header, record headers and data.
+		//record data goes out in writes of at most chunkBytes (0 writes each record at once).
+		inline bool writeCheckpointRecords(std::ostream& file, std::vector<CheckpointRecord>& records, size_t chunkBytes = 0)
+		{
+			CheckpointFileHeader fileHeader{{'S', 'U', 'C', 'H', 'K', 'P', 'T', 0}, checkpointVersion, (uint32_t)records.size()};
+			uint64_t offset = sizeof(CheckpointFileHeader) + records.size() * sizeof(CheckpointRecordHeader);
+			for (CheckpointRecord& record : records)
+			{
+				offset = (offset + checkpointAlignment - 1) / checkpointAlignment * checkpointAlignment;
+				record.header.dataOffset = offset;
+				offset += record.header.dataBytes;
+			}
+
+			file.write((const char*)&fileHeader, sizeof(fileHeader));
+			for (const CheckpointRecord& record : records)
+			{
+				file.write((const char*)&record.header, sizeof(CheckpointRecordHeader));
+			}
+			uint64_t position = sizeof(CheckpointFileHeader) + records.size() * sizeof(CheckpointRecordHeader);
+			const char padding[checkpointAlignment] = {};
+			for (const CheckpointRecord& record : records)
+			{
+				file.write(padding, record.header.dataOffset - position);
+				size_t chunk = chunkBytes ? chunkBytes : record.header.dataBytes;
+				for (size_t written = 0; written < record.header.dataBytes && file; written += chunk)
+				{
+					file.write((const char*)record.data + written, std::min<size_t>(chunk, record.header.dataBytes - written));
+				}
+				position = record.header.dataOffset + record.header.dataBytes;
+			}
+			return file.good();
+		}
+	}
+
+	//writes a TensorField, a DirectSum (of fields, tensors, doubles, ...) or a plain value to path.
+	//returns false if the file could not be written.
+	//chunkBytes > 0 splits the field data into writes of at most that many bytes.
+	template<typename State>
+	bool saveCheckpoint(const std::string& path, const State& state, size_t chunkBytes = 0)
+	{
+		std::vector<CheckpointRecord> records;
+		collectCheckpointRecords(state, records);
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		return file && writeCheckpointRecords(file, records, chunkBytes);
+	}
+
+#if defined(__unix__)
+	//restores a state written by saveCheckpoint. fields are mapped from the file instead of read,
+	//so the restart costs the page faults of what is touched rather than parsing. returns false
+	//(leaving the remaining members untouched) if the file does not match the state's types and shapes.
+	template<typename State>
+	bool loadCheckpoint(const std::string& path, State& state)
+	{
+		int descriptor = open(path.c_str(), O_RDONLY);
+		if (descriptor < 0)
+		{
+			return false;
+		}
+		struct stat status;
+		if (fstat(descriptor, &status) != 0 || (size_t)status.st_size < sizeof(CheckpointFileHeader))
+		{
+			close(descriptor);
+			return false;
+		}
+		size_t fileBytes = status.st_size;
+		void* address = mmap(nullptr, fileBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+		close(descriptor);
+		if (address == MAP_FAILED)
+		{
+			return false;
+		}
+		//every field restored from the file keeps the mapping alive
+		std::shared_ptr<char> mapping((char*)address, [fileBytes](char* mapped){munmap(mapped, fileBytes);});
+
+		const CheckpointFileHeader& fileHeader = *(const CheckpointFileHeader*)mapping.get();
+		if (std::string(fileHeader.magic) != "SUCHKPT" || fileHeader.version != checkpointVersion
+			|| sizeof(CheckpointFileHeader) + fileHeader.recordCount * sizeof(CheckpointRecordHeader) > fileBytes)
+		{
+			return false;
+		}
+		const CheckpointRecordHeader* first = (const CheckpointRecordHeader*)(mapping.get() + sizeof(CheckpointFileHeader));
+		for (size_t i = 0; i < fileHeader.recordCount; ++i)
+		{
+			//records are mapped in place as T*, so their data has to start on an aligned offset
+			if (first[i].dataOffset % checkpointAlignment != 0 || first[i].dataOffset + first[i].dataBytes > fileBytes)
+			{
+				return false;
+			}
+		}
+		std::vector<CheckpointRecord> expected;
+		collectCheckpointRecords((const State&)state, expected);
+		if (expected.size() != fileHeader.recordCount)
+		{
+			return false;
+		}
+		const CheckpointRecordHeader* header = first;
+		return restoreCheckpointRecords(state, mapping, header);
+	}
+#endif
+
+}
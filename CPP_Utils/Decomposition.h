@@ -0,0 +1,447 @@
+namespace SimulationUtilities{
+
+	//transports move halo planes between processes. each one gives
+	//	size_t processRank() const, size_t processCount() const
+	//	void send(size_t destination, size_t tag, const void* data, size_t bytes)
+	//	void receive(size_t source, size_t tag, void* data, size_t bytes)
+	//	void wait()
+	//send and receive only start a transfer, wait() returns once every started transfer is done.
+	//send buffers must not change and receive buffers must not be read before wait().
+	//tag 0 is data sent towards the lower neighbour, tag 1 towards the higher neighbour.
+
+#if defined(__unix__)
+	//transport between processes on one machine through an anonymous shared mapping made
+	//before forking. every (source, tag) pair has a double buffered mailbox, so a send is a
+	//copy into the mailbox and the matching receive is a copy out once it has been published.
+	//only suited to neighbour exchanges (each process sends at most one message per tag per wait).
+	class SharedMemoryTransport
+	{
+		struct alignas(64) Mailbox
+		{
+			std::atomic<uint64_t> published;
+			std::atomic<uint64_t> consumed;
+		};
+
+		struct PendingReceive
+		{
+			size_t source;
+			size_t tag;
+			void* data;
+			size_t bytes;
+		};
+
+		size_t rank;
+		size_t processes;
+		size_t maxMessageBytes;
+		char* region;
+		std::vector<uint64_t> sentCount;
+		std::vector<uint64_t> receivedCount;
+		std::vector<PendingReceive> pending;
+
+		static size_t mailboxBytes(size_t maxMessageBytes)
+		{
+			return sizeof(Mailbox) + 2 * ((maxMessageBytes + 63) / 64 * 64);
+		}
+
+		Mailbox& mailbox(size_t source, size_t tag) const
+		{
+			return *(Mailbox*)(region + (source * 2 + tag) * mailboxBytes(maxMessageBytes));
+		}
+
+		char* slot(size_t source, size_t tag, uint64_t generation) const
+		{
+			return (char*)&mailbox(source, tag) + sizeof(Mailbox) + (generation % 2) * ((maxMessageBytes + 63) / 64 * 64);
+		}
+
+		//stops and reaps children (after a failed fork or an exception in the caller's body,
+		//when they could be waiting forever for messages that will not come)
+		static void killChildren(const std::vector<pid_t>& children)
+		{
+			for (pid_t child : children)
+			{
+				kill(child, SIGKILL);
+			}
+			for (pid_t child : children)
+			{
+				waitpid(child, nullptr, 0);
+			}
+		}
+
+		SharedMemoryTransport(size_t initRank, size_t initProcesses, size_t initMaxMessageBytes, char* initRegion)
+		:
+			rank(initRank),
+			processes(initProcesses),
+			maxMessageBytes(initMaxMessageBytes),
+			region(initRegion),
+			sentCount(2, 0),
+			receivedCount(2 * initProcesses, 0)
+		{
+			pending.reserve(4);
+		}
+	public:
+		size_t processRank() const
+		{
+			return rank;
+		}
+
+		size_t processCount() const
+		{
+			return processes;
+		}
+
+		//mailboxes belong to the sender, so the destination is not needed to find one
+		void send(size_t, size_t tag, const void* data, size_t bytes)
+		{
+			if (bytes > maxMessageBytes)
+			{
+				throw std::invalid_argument("Message is larger than the transport's maxMessageBytes.");
+			}
+			Mailbox& box = mailbox(rank, tag);
+			uint64_t generation = ++sentCount[tag];
+			//the slot is free once the message two generations back has been read
+			while (box.consumed.load(std::memory_order_acquire) + 2 < generation)
+			{
+				std::this_thread::yield();
+			}
+			std::copy((const char*)data, (const char*)data + bytes, slot(rank, tag, generation));
+			box.published.store(generation, std::memory_order_release);
+		}
+
+		void receive(size_t source, size_t tag, void* data, size_t bytes)
+		{
+			if (bytes > maxMessageBytes)
+			{
+				throw std::invalid_argument("Message is larger than the transport's maxMessageBytes.");
+			}
+			pending.push_back({source, tag, data, bytes});
+		}
+
+		void wait()
+		{
+			for (const PendingReceive& message : pending)
+			{
+				Mailbox& box = mailbox(message.source, message.tag);
+				uint64_t generation = ++receivedCount[message.source * 2 + message.tag];
+				while (box.published.load(std::memory_order_acquire) < generation)
+				{
+					std::this_thread::yield();
+				}
+				const char* input = slot(message.source, message.tag, generation);
+				std::copy(input, input + message.bytes, (char*)message.data);
+				box.consumed.store(generation, std::memory_order_release);
+			}
+			pending.clear();
+		}
+
+		//forks processes - 1 children and runs body(transport) in every process (rank 0 is the caller).
+		//messages can be up to maxMessageBytes. children exit when body returns (with status 1 if it
+		//throws), the caller gets true once every child has exited normally. if a fork fails the
+		//children already made are killed and false is returned, an exception from the caller's body
+		//kills the children and is passed on. fork before starting the parallel execution threads.
+		template<typename Body>
+		static bool run(size_t processes, size_t maxMessageBytes, const Body& body)
+		{
+			size_t regionBytes = processes * 2 * mailboxBytes(maxMessageBytes);
+			void* mapping = mmap(nullptr, regionBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+			if (mapping == MAP_FAILED)
+			{
+				return false;
+			}
+			char* region = (char*)mapping;
+			for (size_t i = 0; i < processes * 2; ++i)
+			{
+				Mailbox* box = (Mailbox*)(region + i * mailboxBytes(maxMessageBytes));
+				new (box) Mailbox();
+				box->published.store(0);
+				box->consumed.store(0);
+			}
+
+			//so buffered output is not written again by every child
+			std::cout.flush();
+			std::vector<pid_t> children;
+			for (size_t rank = 1; rank < processes; ++rank)
+			{
+				pid_t child = fork();
+				if (child == 0)
+				{
+					//the child must never return into (or unwind through) the caller's code
+					int status = 0;
+					try
+					{
+						SharedMemoryTransport transport(rank, processes, maxMessageBytes, region);
+						body(transport);
+					}
+					catch (...)
+					{
+						status = 1;
+					}
+					std::cout.flush();
+					_exit(status);
+				}
+				if (child < 0)
+				{
+					killChildren(children);
+					munmap(mapping, regionBytes);
+					return false;
+				}
+				children.push_back(child);
+			}
+			try
+			{
+				SharedMemoryTransport transport(0, processes, maxMessageBytes, region);
+				body(transport);
+			}
+			catch (...)
+			{
+				killChildren(children);
+				munmap(mapping, regionBytes);
+				throw;
+			}
+			bool success = true;
+			for (pid_t child : children)
+			{
+				int status;
+				waitpid(child, &status, 0);
+				success = success && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+			}
+			munmap(mapping, regionBytes);
+			return success;
+		}
+	};
+#endif
+
+#ifdef SIMULATION_UTILITIES_MPI
+	//transport over MPI point to point messages (define SIMULATION_UTILITIES_MPI and link MPI)
+	class MpiTransport
+	{
+		MPI_Comm communicator;
+		std::vector<MPI_Request> requests;
+	public:
+		MpiTransport(MPI_Comm initCommunicator = MPI_COMM_WORLD)
+		:
+			communicator(initCommunicator)
+		{
+			requests.reserve(4);
+		}
+
+		size_t processRank() const
+		{
+			int output;
+			MPI_Comm_rank(communicator, &output);
+			return output;
+		}
+
+		size_t processCount() const
+		{
+			int output;
+			MPI_Comm_size(communicator, &output);
+			return output;
+		}
+
+		void send(size_t destination, size_t tag, const void* data, size_t bytes)
+		{
+			requests.emplace_back();
+			MPI_Isend(data, (int)bytes, MPI_BYTE, (int)destination, (int)tag, communicator, &requests.back());
+		}
+
+		void receive(size_t source, size_t tag, void* data, size_t bytes)
+		{
+			requests.emplace_back();
+			MPI_Irecv(data, (int)bytes, MPI_BYTE, (int)source, (int)tag, communicator, &requests.back());
+		}
+
+		void wait()
+		{
+			MPI_Waitall((int)requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+			requests.clear();
+		}
+	};
+#endif
+
+	//splits a grid into slabs along axis 0, one per process. every slab has halo ghost planes
+	//on each side that has a neighbour (both sides when periodic), so a local stencil of
+	//radius halo sees the same values as on the whole grid.
+	//every process needs at least halo planes of its own (std::invalid_argument otherwise).
+	template<size_t dimensions>
+	struct SlabDecomposition
+	{
+		std::array<size_t, dimensions> globalExtents;
+		size_t processRank;
+		size_t processCount;
+		size_t halo;
+		bool periodic;
+		size_t firstPlane;//first global plane owned
+		size_t planes;//planes owned
+		size_t lowGhosts;
+		size_t highGhosts;
+
+		SlabDecomposition(const std::array<size_t, dimensions>& initGlobalExtents, size_t initProcessRank,
+			size_t initProcessCount, size_t initHalo, bool initPeriodic)
+		:
+			globalExtents(initGlobalExtents),
+			processRank(initProcessRank),
+			processCount(initProcessCount),
+			halo(initHalo),
+			periodic(initPeriodic)
+		{
+			size_t base = globalExtents[0] / processCount;
+			size_t extra = globalExtents[0] % processCount;
+			planes = base + (processRank < extra);
+			firstPlane = processRank * base + std::min(processRank, extra);
+			lowGhosts = hasLowNeighbour() ? halo : 0;
+			highGhosts = hasHighNeighbour() ? halo : 0;
+			//checked on the smallest slab so every process makes the same decision
+			if ((hasLowNeighbour() || hasHighNeighbour()) && base < halo)
+			{
+				throw std::invalid_argument("Every process needs at least halo planes of its own.");
+			}
+		}
+
+		bool hasLowNeighbour() const
+		{
+			return periodic || processRank > 0;
+		}
+
+		bool hasHighNeighbour() const
+		{
+			return periodic || processRank + 1 < processCount;
+		}
+
+		size_t lowNeighbour() const
+		{
+			return (processRank + processCount - 1) % processCount;
+		}
+
+		size_t highNeighbour() const
+		{
+			return (processRank + 1) % processCount;
+		}
+
+		//points in one plane (along axis 0)
+		size_t planePoints() const
+		{
+			size_t output = 1;
+			for (size_t axis = 1; axis < dimensions; ++axis)
+			{
+				output *= globalExtents[axis];
+			}
+			return output;
+		}
+
+		//grid of the local block, ghost planes included
+		DynamicExtents<dimensions> localGrid() const
+		{
+			std::array<size_t, dimensions> localExtents = globalExtents;
+			localExtents[0] = lowGhosts + planes + highGhosts;
+			return DynamicExtents<dimensions>(localExtents);
+		}
+
+		bool owns(size_t globalPoint) const
+		{
+			size_t plane = globalPoint / planePoints();
+			return plane >= firstPlane && plane < firstPlane + planes;
+		}
+
+		//local point index of a point of the whole grid (owned or ghost)
+		size_t localPoint(size_t globalPoint) const
+		{
+			size_t plane = globalPoint / planePoints();
+			return (plane + lowGhosts - firstPlane) * planePoints() + globalPoint % planePoints();
+		}
+
+		//point index on the whole grid of a local point (ghost planes wrap around when periodic)
+		size_t globalPoint(size_t localPoint) const
+		{
+			size_t plane = (localPoint / planePoints() + firstPlane + globalExtents[0] - lowGhosts) % globalExtents[0];
+			return plane * planePoints() + localPoint % planePoints();
+		}
+	};
+
+	//the part of a tensor field on a decomposed grid that this process owns, plus ghost planes.
+	//local() is an ordinary DynamicTensorField, so expressions and gradients run on the local
+	//block as usual. after an exchange the ghost planes hold the neighbours' values, so gradients
+	//are exact on every owned point (use the ignoreBoundary gradients unless the grid is also
+	//periodic along the other axes, a non periodic decomposition keeps the physical boundary).
+	//to overlap communication with computation, call beginHaloExchange, do work that does not
+	//read ghost planes or write the halo owned planes next to them, then finishHaloExchange.
+	template<size_t dimensions, size_t rank, typename Transport, typename T = double>
+	class DistributedTensorField
+	{
+		static constexpr size_t components = Template_Power<dimensions, rank>::value;
+
+		SlabDecomposition<dimensions> decomposition;
+		Transport* transport;
+		DynamicTensorField<dimensions, rank, T> field;
+
+		size_t planeScalars() const
+		{
+			return decomposition.planePoints() * components;
+		}
+	public:
+		//halo defaults to the radius of the fourth order gradient stencil
+		DistributedTensorField(Transport& initTransport, const std::array<size_t, dimensions>& globalExtents,
+			bool periodic = false, size_t halo = FourthOrderFirstDerivative::radius)
+		:
+			decomposition(globalExtents, initTransport.processRank(), initTransport.processCount(), halo, periodic),
+			transport(&initTransport),
+			field(decomposition.localGrid())
+		{}
+
+		//largest message an exchange sends (for sizing a SharedMemoryTransport)
+		static size_t haloMessageBytes(const std::array<size_t, dimensions>& globalExtents,
+			size_t halo = FourthOrderFirstDerivative::radius)
+		{
+			size_t output = halo * components * sizeof(T);
+			for (size_t axis = 1; axis < dimensions; ++axis)
+			{
+				output *= globalExtents[axis];
+			}
+			return output;
+		}
+
+		DynamicTensorField<dimensions, rank, T>& local()
+		{
+			return field;
+		}
+
+		const DynamicTensorField<dimensions, rank, T>& local() const
+		{
+			return field;
+		}
+
+		const SlabDecomposition<dimensions>& getDecomposition() const
+		{
+			return decomposition;
+		}
+
+		void beginHaloExchange()
+		{
+			T* data = field.getData();
+			size_t halo = decomposition.halo;
+			size_t bytes = halo * planeScalars() * sizeof(T);
+			size_t ownedEnd = decomposition.lowGhosts + decomposition.planes;
+			if (decomposition.hasLowNeighbour())
+			{
+				transport->receive(decomposition.lowNeighbour(), 1, data, bytes);
+				transport->send(decomposition.lowNeighbour(), 0, data + decomposition.lowGhosts * planeScalars(), bytes);
+			}
+			if (decomposition.hasHighNeighbour())
+			{
+				transport->receive(decomposition.highNeighbour(), 0, data + ownedEnd * planeScalars(), bytes);
+				transport->send(decomposition.highNeighbour(), 1, data + (ownedEnd - halo) * planeScalars(), bytes);
+			}
+		}
+
+		void finishHaloExchange()
+		{
+			transport->wait();
+		}
+
+		void exchangeHalos()
+		{
+			beginHaloExchange();
+			finishHaloExchange();
+		}
+	};
+
+}
@@ -0,0 +1,340 @@
+namespace SimulationUtilities{
+
+	namespace
+	{
+		//each operator is one pass of the stencil engine for the grid: the derivatives of a row (or block) of
+		//points go to a small per thread buffer and are combined into the operator's output straight away,
+		//so no rank + 1 field is built and the sweep runs on the parallel execution threads.
+
+		//derivative along axis of stored component c of point i, in the buffers the engines hand out
+		template<size_t dimensions, size_t components, typename T, typename Layout>
+		struct Point_Derivatives
+		{
+			const T* data;
+			size_t componentStride;
+
+			T operator()(size_t i, size_t axis, size_t c) const
+			{
+				return data[i * Layout::pointStride(dimensions * components) + (axis * components + c) * componentStride];
+			}
+		};
+
+		//the derivatives divergence reads: component c along axis is used if an element with axis as its first index is stored in c
+		template<size_t dimensions, size_t rank, typename Symmetry>
+		struct Divergence_Derivatives
+		{
+			typedef Symmetry_Storage<dimensions, rank, Symmetry> Storage;
+			static constexpr size_t rest = Template_Power<dimensions, rank - 1>::value;
+
+			static constexpr std::array<bool, dimensions * Storage::components> build()
+			{
+				std::array<bool, dimensions * Storage::components> output{};
+				for (size_t axis = 0; axis < dimensions; ++axis)
+				{
+					for (size_t element = axis * rest; element < (axis + 1) * rest; ++element)
+					{
+						if (Storage::sign(element) != 0)
+						{
+							output[axis * Storage::components + Storage::position(element)] = true;
+						}
+					}
+				}
+				return output;
+			}
+
+			static constexpr std::array<bool, dimensions * Storage::components> table = build();
+
+			static constexpr bool used(size_t axis, size_t c)
+			{
+				return table[axis * Storage::components + c];
+			}
+		};
+
+		//curl reads the off diagonal derivatives
+		struct Curl_Derivatives
+		{
+			static constexpr bool used(size_t axis, size_t c)
+			{
+				return axis != c;
+			}
+		};
+
+		//runs combine(firstPoint, count, derivatives) over the grid, derivatives being a Point_Derivatives
+		//of input with Stencil for the count points from firstPoint (only the Derivatives it uses are computed)
+		template<typename Stencil, bool periodic, typename Derivatives, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry,
+			typename Combine>
+		void combineDerivatives(const GridTensorField<Grid, rank, T, Layout, Symmetry>& input,
+			const std::array<double, Grid::dimensions>& spacing, const Combine& combine)
+		{
+			static_assert(!Grid::fixed || Grid::smallestExtent >= Stencil::width, "Every axis needs at least order + 1 points for this stencil.");
+			constexpr size_t dimensions = Grid::dimensions;
+			constexpr size_t components = Symmetry_Storage<dimensions, rank, Symmetry>::components;
+			auto pointCombine = [&](size_t firstPoint, size_t count, const T* derivatives, size_t componentStride)
+			{
+				combine(firstPoint, count, Point_Derivatives<dimensions, components, T, Layout>{derivatives, componentStride});
+			};
+			if constexpr (Grid::rowMajor)
+			{
+				GradientStencilEngine<dimensions, components, T, Stencil, periodic, Layout, Derivatives>
+					(input.getGrid().extents, spacing.data()).applyCombined(input.getData(), pointCombine);
+			}
+			else
+			{
+				OrderedGradientStencilEngine<Grid, components, T, Stencil, periodic, Layout, Derivatives>
+					(input.getGrid(), spacing.data()).applyCombined(input.getData(), pointCombine);
+			}
+		}
+
+		//component c of point p of a field with components values per point and points points
+		template<typename Layout>
+		inline size_t fieldOffset(size_t p, size_t c, size_t components, size_t points)
+		{
+			return p * Layout::pointStride(components) + c * Layout::componentStride(points);
+		}
+
+		template<typename Stencil, bool periodic, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+		GridTensorField<Grid, rank - 1, T, Layout, typename Divergence_Symmetry<Symmetry, rank>::T> divergenceSweep(
+			const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+		{
+			constexpr size_t dimensions = Grid::dimensions;
+			typedef Symmetry_Storage<dimensions, rank, Symmetry> InputStorage;
+			typedef Symmetry_Storage<dimensions, rank - 1, typename Divergence_Symmetry<Symmetry, rank>::T> OutputStorage;
+			constexpr size_t rest = Template_Power<dimensions, rank - 1>::value;
+
+			GridTensorField<Grid, rank - 1, T, Layout, typename Divergence_Symmetry<Symmetry, rank>::T> output(input.getGrid());
+			T* data = output.getData();
+			size_t points = output.size();
+			combineDerivatives<Stencil, periodic, Divergence_Derivatives<dimensions, rank, Symmetry>>(input, spacing, [&](size_t firstPoint, size_t count, const auto& derivative)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					for (size_t o = 0; o < OutputStorage::components; ++o)
+					{
+						//d_a F(a, rest...) for the element o stands for
+						T sum = T();
+						for (size_t axis = 0; axis < dimensions; ++axis)
+						{
+							size_t element = axis * rest + OutputStorage::canonical(o);
+							int sign = InputStorage::sign(element);
+							if (sign != 0)
+							{
+								sum += T(sign) * derivative(i, axis, InputStorage::position(element));
+							}
+						}
+						data[fieldOffset<Layout>(firstPoint + i, o, OutputStorage::components, points)] = sum;
+					}
+				}
+			});
+			return output;
+		}
+
+		template<typename Stencil, bool periodic, typename Grid, typename T, typename Layout, typename Symmetry>
+		GridTensorField<Grid, 1, T, Layout> curlSweep(const GridTensorField<Grid, 1, T, Layout, Symmetry>& input,
+			const std::array<double, Grid::dimensions>& spacing)
+		{
+			GridTensorField<Grid, 1, T, Layout> output(input.getGrid());
+			T* data = output.getData();
+			size_t points = output.size();
+			combineDerivatives<Stencil, periodic, Curl_Derivatives>(input, spacing, [&](size_t firstPoint, size_t count, const auto& derivative)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					//epsilon_ijk d_j F_k, only the off diagonal derivatives are read
+					for (size_t a = 0; a < 3; ++a)
+					{
+						size_t b = (a + 1) % 3;
+						size_t c = (a + 2) % 3;
+						data[fieldOffset<Layout>(firstPoint + i, a, 3, points)] = derivative(i, b, c) - derivative(i, c, b);
+					}
+				}
+			});
+			return output;
+		}
+
+		template<typename Stencil, bool periodic, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+		GridTensorField<Grid, rank, T, Layout, Symmetry> laplacianSweep(const GridTensorField<Grid, rank, T, Layout, Symmetry>& input,
+			const std::array<double, Grid::dimensions>& spacing)
+		{
+			constexpr size_t dimensions = Grid::dimensions;
+			constexpr size_t components = Symmetry_Storage<dimensions, rank, Symmetry>::components;
+
+			GridTensorField<Grid, rank, T, Layout, Symmetry> output(input.getGrid());
+			T* data = output.getData();
+			size_t points = output.size();
+			combineDerivatives<Stencil, periodic, All_Derivatives>(input, spacing, [&](size_t firstPoint, size_t count, const auto& derivative)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					for (size_t c = 0; c < components; ++c)
+					{
+						T sum = T();
+						for (size_t axis = 0; axis < dimensions; ++axis)
+						{
+							sum += derivative(i, axis, c);
+						}
+						data[fieldOffset<Layout>(firstPoint + i, c, components, points)] = sum;
+					}
+				}
+			});
+			return output;
+		}
+
+		template<typename Stencil, bool periodic, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+		GridTensorField<Grid, rank, T, Layout, Symmetry> advectSweep(const GridTensorField<Grid, 1, T, Layout>& velocity,
+			const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+		{
+			constexpr size_t dimensions = Grid::dimensions;
+			constexpr size_t components = Symmetry_Storage<dimensions, rank, Symmetry>::components;
+			checkSameExtents(velocity.getGrid(), input.getGrid(), "The velocity must be on the grid of the advected field.");
+
+			GridTensorField<Grid, rank, T, Layout, Symmetry> output(input.getGrid());
+			T* data = output.getData();
+			const T* v = velocity.getData();
+			size_t points = output.size();
+			combineDerivatives<Stencil, periodic, All_Derivatives>(input, spacing, [&](size_t firstPoint, size_t count, const auto& derivative)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					size_t p = firstPoint + i;
+					for (size_t c = 0; c < components; ++c)
+					{
+						T sum = T();
+						for (size_t axis = 0; axis < dimensions; ++axis)
+						{
+							sum += v[fieldOffset<Layout>(p, axis, dimensions, points)] * derivative(i, axis, c);
+						}
+						data[fieldOffset<Layout>(p, c, components, points)] = sum;
+					}
+				}
+			});
+			return output;
+		}
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank - 1, T, Layout, typename Divergence_Symmetry<Symmetry, rank>::T> divergence_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//d_i F_i... (the derivative direction contracted with the first index), a rank - 1 field
+		//with the symmetry the input has among its other indices
+		static_assert(rank != 0, "Divergence needs a field of rank 1 or more.");
+		return divergenceSweep<FiniteDifferenceStencil<1, order>, false>(input, spacing);
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank - 1, T, Layout, typename Divergence_Symmetry<Symmetry, rank>::T> divergence_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return divergence_ignoreBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank - 1, T, Layout, typename Divergence_Symmetry<Symmetry, rank>::T> divergence_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//divergence_ignoreBoundary with periodic boundaries
+		static_assert(rank != 0, "Divergence needs a field of rank 1 or more.");
+		return divergenceSweep<FiniteDifferenceStencil<1, order>, true>(input, spacing);
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank - 1, T, Layout, typename Divergence_Symmetry<Symmetry, rank>::T> divergence_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return divergence_periodicBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, 1, T, Layout> curl_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//epsilon_ijk d_j F_k of a 3D vector field, only the six off diagonal derivatives are taken
+		static_assert(Grid::dimensions == 3 && rank == 1, "Curl needs a 3D vector field.");
+		return curlSweep<FiniteDifferenceStencil<1, order>, false>(input, spacing);
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, 1, T, Layout> curl_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return curl_ignoreBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, 1, T, Layout> curl_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//curl_ignoreBoundary with periodic boundaries
+		static_assert(Grid::dimensions == 3 && rank == 1, "Curl needs a 3D vector field.");
+		return curlSweep<FiniteDifferenceStencil<1, order>, true>(input, spacing);
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, 1, T, Layout> curl_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return curl_periodicBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank, T, Layout, Symmetry> laplacian_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//sum of the second derivatives along every axis from the compact second derivative stencil
+		//(not the divergence of the gradient), same rank and symmetry as the input
+		return laplacianSweep<FiniteDifferenceStencil<2, order>, false>(input, spacing);
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank, T, Layout, Symmetry> laplacian_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return laplacian_ignoreBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank, T, Layout, Symmetry> laplacian_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//laplacian_ignoreBoundary with periodic boundaries
+		return laplacianSweep<FiniteDifferenceStencil<2, order>, true>(input, spacing);
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank, T, Layout, Symmetry> laplacian_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return laplacian_periodicBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank, T, Layout, Symmetry> advect_ignoreBoundary(
+		const GridTensorField<Grid, 1, T, Layout>& velocity, const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//(v . grad) F = v_j d_j F..., same rank and symmetry as the input
+		return advectSweep<FiniteDifferenceStencil<1, order>, false>(velocity, input, spacing);
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank, T, Layout, Symmetry> advect_ignoreBoundary(
+		const GridTensorField<Grid, 1, T, Layout>& velocity, const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return advect_ignoreBoundary<order>(velocity, input, uniformSpacing<Grid::dimensions>(dx));
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank, T, Layout, Symmetry> advect_periodicBoundary(
+		const GridTensorField<Grid, 1, T, Layout>& velocity, const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//advect_ignoreBoundary with periodic boundaries
+		return advectSweep<FiniteDifferenceStencil<1, order>, true>(velocity, input, spacing);
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank, T, Layout, Symmetry> advect_periodicBoundary(
+		const GridTensorField<Grid, 1, T, Layout>& velocity, const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return advect_periodicBoundary<order>(velocity, input, uniformSpacing<Grid::dimensions>(dx));
+	}
+
+}
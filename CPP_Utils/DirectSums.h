@@ -5,6 +5,10 @@ namespace SimulationUtilities{
 	template<typename... VectorTypes>
 	std::ostream& operator<<(std::ostream& os, const DirectSum<VectorTypes...>& thing);
 
+	//defined in Reductions.h
+	template<typename State>
+	auto dotProduct(const State& left, const State& right);
+
 	namespace
 	{
 		template<typename first, typename... VectorTypes>
@@ -101,16 +105,6 @@ namespace SimulationUtilities{
 			div(std::get<Is>(left)..., right);
 		}
 
-		static double dot(const VectorTypes&... left, const VectorTypes&... right){
-			return ((left * right) + ...);
-		}
-
-		template<size_t... Is>
-		static inline double dotTuple(const DataType& left, const DataType& right,
-			std::index_sequence<Is...> seq)
-		{
-			return dot(std::get<Is>(left)..., std::get<Is>(right)...);
-		}
 	public:
 		// DirectSum(){
 		// 	initTuple(values, seq());
@@ -165,15 +159,16 @@ namespace SimulationUtilities{
 			return *this;
 		}
 
-		double dotProduct(const SumType& other) const{
-			return dotTuple(values, other.values, seq());
+		//the parallel reduction of Reductions.h over every member
+		auto dotProduct(const SumType& other) const{
+			return SimulationUtilities::dotProduct(*this, other);
 		}
 
-		double defaultSquareMagnitude() const{
+		auto defaultSquareMagnitude() const{
 			return dotProduct(*this);
 		}
 
-		double defaultMagnitude() const
+		auto defaultMagnitude() const
 		{
 			return std::sqrt(defaultSquareMagnitude());
 		}
@@ -227,8 +222,8 @@ namespace SimulationUtilities{
 	}
 
 	template<typename... VectorTypes>
-	double operator*(DirectSum<VectorTypes...> left, DirectSum<VectorTypes...> right){
-		return left.defualtDot(right);
+	auto operator*(const DirectSum<VectorTypes...>& left, const DirectSum<VectorTypes...>& right){
+		return left.dotProduct(right);
 	}
 
 	template<typename T, typename... VectorTypes>
@@ -244,7 +239,7 @@ namespace SimulationUtilities{
 		}
 		template<typename... VectorTypes>
 		static auto& dynamicGet(DirectSum<VectorTypes...>& input){
-			return Projection<Is...>::get(std::get<first>(input.values));
+			return Projection<Is...>::dynamicGet(std::get<first>(input.values));
 		}
 	};
 
@@ -267,7 +262,7 @@ namespace SimulationUtilities{
 
 	template<size_t... Is, typename... VectorTypes>
 	auto& getReference(DirectSum<VectorTypes...>& input){
-		return Projection<Is...>::get(input);
+		return Projection<Is...>::dynamicGet(input);
 	}
 
 	template<size_t... Is, typename... VectorTypes>
@@ -280,10 +275,5 @@ namespace SimulationUtilities{
 		Projection<Is...>::dynamicGet(input) = value;
 	}
 
-	template<typename... VectorTypes>
-	double dotProduct(const DirectSum<VectorTypes...>& left, const DirectSum<VectorTypes...>& right)
-	{
-		return left.dotProduct(right);
-	}
 
 }
\ No newline at end of file
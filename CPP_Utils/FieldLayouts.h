@@ -0,0 +1,23 @@
+namespace SimulationUtilities{
+
+	//storage orders for the scalars of a field. with components scalars per grid point,
+	//component c of point p lives at p * pointStride(components) + c * componentStride(points).
+
+	//array of structures, the tensor at each point is contiguous (default)
+	struct PointMajor
+	{
+		static constexpr bool componentMajor = false;
+		static constexpr size_t pointStride(size_t components){return components;}
+		static constexpr size_t componentStride(size_t){return 1;}
+	};
+
+	//structure of arrays, each component is contiguous across the grid
+	//so per component kernels (stencils, simd loops) run at unit stride
+	struct ComponentMajor
+	{
+		static constexpr bool componentMajor = true;
+		static constexpr size_t pointStride(size_t){return 1;}
+		static constexpr size_t componentStride(size_t points){return points;}
+	};
+
+}
@@ -0,0 +1,317 @@
+namespace SimulationUtilities{
+
+	enum class GhostCondition{Periodic, Dirichlet, Neumann, Reflective, External};
+
+	enum class GhostCentring{Point, Face};
+
+	//what fills the ghost cells on one side of an axis. the boundary is the edge point of the interior,
+	//or with GhostCentring::Face (cell centred data) the face half a spacing beyond it:
+	//Periodic copies the other end of the interior,
+	//Dirichlet mirrors oddly about value (ghost = 2 * value - inside), for every component,
+	//Neumann mirrors evenly and adds value per point of distance on both sides (value is the outward
+	//normal derivative times the spacing, 0 gives zero gradient),
+	//Reflective mirrors evenly but flips the tensor components along the axis (a slip wall for vectors),
+	//External leaves the ghost cells as they are, for ghosts set by the caller (from neighbouring blocks).
+	template<typename T = double>
+	struct GhostBoundary
+	{
+		GhostCondition condition;
+		T value;
+		GhostCentring centring = GhostCentring::Point;
+
+		static GhostBoundary periodic()
+		{
+			return {GhostCondition::Periodic, T()};
+		}
+
+		static GhostBoundary dirichlet(T value)
+		{
+			return {GhostCondition::Dirichlet, value};
+		}
+
+		static GhostBoundary neumann(T value = T())
+		{
+			return {GhostCondition::Neumann, value};
+		}
+
+		static GhostBoundary reflective()
+		{
+			return {GhostCondition::Reflective, T()};
+		}
+
+		static GhostBoundary external()
+		{
+			return {GhostCondition::External, T()};
+		}
+
+		//the same condition with the boundary at the face
+		GhostBoundary atFace() const
+		{
+			return {condition, value, GhostCentring::Face};
+		}
+	};
+
+	//tensor field stored with ghosts layers of ghost cells around its interior on every axis
+	//(the default covers the fourth order stencils, order / 2 are needed for the others).
+	//fillGhosts() sets the ghost cells from the boundary conditions, after which
+	//gradients and other stencils treat every interior point the same way: one central stencil
+	//loop with no wrapping or one sided variants. local() is the padded field as an ordinary
+	//DynamicTensorField, so expressions run on it as usual (interior and ghost points alike).
+	template<size_t dimensions, size_t rank, typename T = double, size_t ghosts = FourthOrderFirstDerivative::radius>
+	class GhostedTensorField
+	{
+		static constexpr size_t components = Template_Power<dimensions, rank>::value;
+
+		std::array<size_t, dimensions> interiorExtents;
+		DynamicTensorField<dimensions, rank, T> field;
+		std::array<std::array<GhostBoundary<T>, 2>, dimensions> boundaries;
+
+		static DynamicExtents<dimensions> paddedGrid(const std::array<size_t, dimensions>& interior)
+		{
+			std::array<size_t, dimensions> padded = interior;
+			for (size_t& extent : padded)
+			{
+				extent += 2 * ghosts;
+			}
+			return DynamicExtents<dimensions>(padded);
+		}
+
+		//-1 for the components with an odd number of indices along axis
+		static std::array<T, components> reflectionSigns(size_t axis)
+		{
+			std::array<T, components> output;
+			for (size_t c = 0; c < components; ++c)
+			{
+				bool odd = false;
+				for (size_t rest = c, i = 0; i < rank; ++i, rest /= dimensions)
+				{
+					odd ^= rest % dimensions == axis;
+				}
+				output[c] = odd ? T(-1) : T(1);
+			}
+			return output;
+		}
+
+		//sets the ghost point ghost, distance points outside the edge point, from the interior point source
+		//(its mirror image about the boundary)
+		static void fillPoint(T* ghost, const T* source, size_t distance, const GhostBoundary<T>& boundary,
+			const std::array<T, components>& signs)
+		{
+			size_t separation = boundary.centring == GhostCentring::Face ? 2 * distance - 1 : 2 * distance;
+			for (size_t c = 0; c < components; ++c)
+			{
+				switch (boundary.condition)
+				{
+					case GhostCondition::Periodic:
+						ghost[c] = source[c];
+						break;
+					case GhostCondition::Dirichlet:
+						ghost[c] = 2 * boundary.value - source[c];
+						break;
+					case GhostCondition::Neumann:
+						ghost[c] = source[c] + T(separation) * boundary.value;
+						break;
+					case GhostCondition::Reflective:
+						ghost[c] = signs[c] * source[c];
+						break;
+					case GhostCondition::External:
+						break;
+				}
+			}
+		}
+
+		//how far inside the edge point the mirror image of the ghost distance points outside it is
+		static size_t mirrorDistance(size_t distance, const GhostBoundary<T>& boundary)
+		{
+			return boundary.centring == GhostCentring::Face ? distance - 1 : distance;
+		}
+
+		//fills every ghost layer on both sides of axis, one line of points along axis at a time
+		void fillAxis(size_t axis)
+		{
+			const DynamicExtents<dimensions>& grid = field.getGrid();
+			const GhostBoundary<T>& low = boundaries[axis][0];
+			const GhostBoundary<T>& high = boundaries[axis][1];
+			if (low.condition == GhostCondition::External && high.condition == GhostCondition::External)
+			{
+				return;
+			}
+			std::array<T, components> signs = reflectionSigns(axis);
+			size_t inner = grid.stride(axis);
+			size_t step = inner * components;
+			size_t planePoints = grid.points / grid.extents[axis];
+			size_t first = ghosts;
+			size_t last = ghosts + interiorExtents[axis] - 1;
+			T* data = field.getData();
+			parallelFor(planePoints, [&](size_t begin, size_t end)
+			{
+				for (size_t q = begin; q < end; ++q)
+				{
+					T* line = data + (q / inner * grid.extents[axis] * inner + q % inner) * components;
+					for (size_t distance = 1; distance <= ghosts; ++distance)
+					{
+						fillPoint(line + (first - distance) * step, line + (low.condition == GhostCondition::Periodic ?
+							last + 1 - distance : first + mirrorDistance(distance, low)) * step, distance, low, signs);
+						fillPoint(line + (last + distance) * step, line + (high.condition == GhostCondition::Periodic ?
+							first - 1 + distance : last - mirrorDistance(distance, high)) * step, distance, high, signs);
+					}
+				}
+			});
+		}
+	public:
+		//every side starts out periodic
+		GhostedTensorField(const std::array<size_t, dimensions>& initInteriorExtents)
+		:
+			interiorExtents(initInteriorExtents),
+			field(paddedGrid(initInteriorExtents))
+		{
+			setBoundary(GhostBoundary<T>::periodic());
+		}
+
+		DynamicTensorField<dimensions, rank, T>& local()
+		{
+			return field;
+		}
+
+		const DynamicTensorField<dimensions, rank, T>& local() const
+		{
+			return field;
+		}
+
+		const std::array<size_t, dimensions>& getInteriorExtents() const
+		{
+			return interiorExtents;
+		}
+
+		//point index in local() of an interior position
+		size_t paddedPoint(const std::array<size_t, dimensions>& interiorPosition) const
+		{
+			size_t output = 0;
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				output += (interiorPosition[axis] + ghosts) * field.getGrid().stride(axis);
+			}
+			return output;
+		}
+
+		//side 0 is the start of axis, side 1 the end
+		void setBoundary(size_t axis, size_t side, const GhostBoundary<T>& boundary)
+		{
+			boundaries[axis][side] = boundary;
+		}
+
+		void setBoundary(const GhostBoundary<T>& boundary)
+		{
+			for (auto& axisBoundaries : boundaries)
+			{
+				axisBoundaries.fill(boundary);
+			}
+		}
+
+		//sets every ghost cell from the boundary conditions, one parallel pass per axis. axes are filled
+		//in order over the whole padded extent of the others, so edges and corners come out consistent.
+		//periodic and face centred sides need at least ghosts interior points, the other mirrored ones ghosts + 1
+		//(std::invalid_argument otherwise).
+		void fillGhosts()
+		{
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				for (const GhostBoundary<T>& boundary : boundaries[axis])
+				{
+					bool edge = boundary.condition != GhostCondition::Periodic && boundary.condition != GhostCondition::External
+						&& boundary.centring == GhostCentring::Point;
+					if (interiorExtents[axis] < (edge ? ghosts + 1 : ghosts))
+					{
+						throw std::invalid_argument("Too few interior points along an axis for its ghost cells.");
+					}
+				}
+			}
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				fillAxis(axis);
+			}
+		}
+
+		//copies an unpadded field into the interior
+		void setInterior(const DynamicTensorField<dimensions, rank, T>& input)
+		{
+			const DynamicExtents<dimensions>& grid = input.getGrid();
+			size_t rowLength = grid.extents[dimensions - 1];
+			size_t rows = grid.points / rowLength;
+			for (size_t row = 0; row < rows; ++row)
+			{
+				std::array<size_t, dimensions> position = {};
+				for (size_t axis = 0, rest = row * rowLength; axis < dimensions; ++axis)
+				{
+					position[axis] = rest / grid.stride(axis) % grid.extents[axis];
+				}
+				std::copy(input.getData() + row * rowLength * components, input.getData() + (row + 1) * rowLength * components,
+					field.getData() + paddedPoint(position) * components);
+			}
+		}
+
+		//unpadded copy of the interior
+		DynamicTensorField<dimensions, rank, T> getInterior() const
+		{
+			DynamicTensorField<dimensions, rank, T> output{DynamicExtents<dimensions>(interiorExtents)};
+			const DynamicExtents<dimensions>& grid = output.getGrid();
+			size_t rowLength = grid.extents[dimensions - 1];
+			size_t rows = grid.points / rowLength;
+			for (size_t row = 0; row < rows; ++row)
+			{
+				std::array<size_t, dimensions> position = {};
+				for (size_t axis = 0, rest = row * rowLength; axis < dimensions; ++axis)
+				{
+					position[axis] = rest / grid.stride(axis) % grid.extents[axis];
+				}
+				const T* source = field.getData() + paddedPoint(position) * components;
+				std::copy(source, source + rowLength * components, output.getData() + row * rowLength * components);
+			}
+			return output;
+		}
+	};
+
+	namespace
+	{
+		template<typename Stencil, size_t dimensions, size_t rank, typename T, size_t ghosts>
+		GhostedTensorField<dimensions, rank + 1, T, ghosts> applyGhostedStencil(const GhostedTensorField<dimensions, rank, T, ghosts>& input,
+			const std::array<double, dimensions>& spacing)
+		{
+			static_assert(ghosts >= Stencil::radius, "The field needs at least order / 2 ghost layers for this stencil.");
+			GhostedTensorField<dimensions, rank + 1, T, ghosts> output(input.getInteriorExtents());
+			GradientStencilEngine<dimensions, Template_Power<dimensions, rank>::value, T, Stencil, false>
+				(input.local().getGrid().extents, spacing.data(), ghosts).apply(input.local().getData(), output.local().getData());
+			return output;
+		}
+	}
+
+	//gradient of the interior of a ghosted field (call fillGhosts() first) with the central stencil everywhere.
+	//the result has the same interior and ghost width, its ghost cells are left at zero.
+	template<size_t order = 4, size_t dimensions, size_t rank, typename T, size_t ghosts>
+	GhostedTensorField<dimensions, rank + 1, T, ghosts> gradient(const GhostedTensorField<dimensions, rank, T, ghosts>& input,
+		const std::array<double, dimensions>& spacing)
+	{
+		return applyGhostedStencil<FiniteDifferenceStencil<1, order>>(input, spacing);
+	}
+
+	template<size_t order = 4, size_t dimensions, size_t rank, typename T, size_t ghosts>
+	GhostedTensorField<dimensions, rank + 1, T, ghosts> gradient(const GhostedTensorField<dimensions, rank, T, ghosts>& input, double dx)
+	{
+		return gradient<order>(input, uniformSpacing<dimensions>(dx));
+	}
+
+	//second derivative along each axis of the interior of a ghosted field, laid out like the gradient
+	template<size_t order = 4, size_t dimensions, size_t rank, typename T, size_t ghosts>
+	GhostedTensorField<dimensions, rank + 1, T, ghosts> secondDerivative(const GhostedTensorField<dimensions, rank, T, ghosts>& input,
+		const std::array<double, dimensions>& spacing)
+	{
+		return applyGhostedStencil<FiniteDifferenceStencil<2, order>>(input, spacing);
+	}
+
+	template<size_t order = 4, size_t dimensions, size_t rank, typename T, size_t ghosts>
+	GhostedTensorField<dimensions, rank + 1, T, ghosts> secondDerivative(const GhostedTensorField<dimensions, rank, T, ghosts>& input, double dx)
+	{
+		return secondDerivative<order>(input, uniformSpacing<dimensions>(dx));
+	}
+
+}
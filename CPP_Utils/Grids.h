@@ -0,0 +1,284 @@
+namespace SimulationUtilities{
+
+	//grid types give dimensions, extents[axis] and points, and map between point indices and positions:
+	//index({position...}), coordinate(point, axis) and moveTo(point, axis, target) (the point with its
+	//coordinate along axis changed to target). rowMajor grids also give stride(axis), tiled grids give it
+	//for neighbours in the same tile.
+	//pointOrder is what checkpoints record (0 row major, 1 tiled, 2 Morton), with tile the tile size.
+	//fixedPoints and smallestExtent are only meaningful for fixed (compile time) grids, 0 otherwise.
+
+	//shape of a row major grid with its own number of points along every axis
+	template<size_t... axisExtents>
+	struct Extents
+	{
+		static constexpr bool fixed = true;
+		static constexpr size_t dimensions = sizeof...(axisExtents);
+		static constexpr size_t extents[dimensions] = {axisExtents...};
+		static constexpr size_t points = (1 * ... * axisExtents);
+		static constexpr size_t fixedPoints = points;
+		static constexpr size_t smallestExtent = std::min({axisExtents...});
+		static constexpr bool rowMajor = true;
+		static constexpr uint32_t pointOrder = 0;
+		static constexpr size_t tile = 0;
+
+		//distance between neighbouring points along axis
+		static constexpr size_t stride(size_t axis)
+		{
+			size_t output = 1;
+			for (size_t i = axis + 1; i < dimensions; ++i)
+			{
+				output *= extents[i];
+			}
+			return output;
+		}
+
+		static constexpr size_t index(const std::array<size_t, dimensions>& position)
+		{
+			size_t output = 0;
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				output += position[axis] * stride(axis);
+			}
+			return output;
+		}
+
+		static constexpr size_t coordinate(size_t point, size_t axis)
+		{
+			return point / stride(axis) % extents[axis];
+		}
+
+		static constexpr size_t moveTo(size_t point, size_t axis, size_t target)
+		{
+			return point + (target - coordinate(point, axis)) * stride(axis);
+		}
+	};
+
+	//grid shape chosen at run time, for example from a config file. a gradient needs at least
+	//order + 1 points along every axis (5 for the default order), applying a stencil to a
+	//smaller grid throws std::invalid_argument.
+	template<size_t dims>
+	struct DynamicExtents
+	{
+		static constexpr bool fixed = false;
+		static constexpr size_t dimensions = dims;
+		static constexpr size_t fixedPoints = 0;
+		static constexpr size_t smallestExtent = 0;
+		size_t extents[dimensions];
+		size_t strides[dimensions];
+		size_t points;
+
+		DynamicExtents()
+		:
+			points(0)
+		{
+			std::fill(extents, extents + dimensions, 0);
+			std::fill(strides, strides + dimensions, 0);
+		}
+
+		DynamicExtents(const std::array<size_t, dimensions>& initExtents)
+		:
+			points(1)
+		{
+			for (size_t axis = dimensions; axis > 0; --axis)
+			{
+				extents[axis - 1] = initExtents[axis - 1];
+				strides[axis - 1] = points;
+				points *= extents[axis - 1];
+			}
+		}
+
+		static constexpr bool rowMajor = true;
+		static constexpr uint32_t pointOrder = 0;
+		static constexpr size_t tile = 0;
+
+		size_t stride(size_t axis) const
+		{
+			return strides[axis];
+		}
+
+		size_t index(const std::array<size_t, dimensions>& position) const
+		{
+			size_t output = 0;
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				output += position[axis] * strides[axis];
+			}
+			return output;
+		}
+
+		size_t coordinate(size_t point, size_t axis) const
+		{
+			return point / strides[axis] % extents[axis];
+		}
+
+		size_t moveTo(size_t point, size_t axis, size_t target) const
+		{
+			return point + (target - coordinate(point, axis)) * strides[axis];
+		}
+	};
+
+	//grid stored tile by tile: cubes of tileSize points along every axis (each extent a multiple
+	//of tileSize) are contiguous, row major inside a tile and in tile order. a stencil along any
+	//axis stays inside a few tiles, so it does not stride across the whole grid like row major
+	//order does along the first axis.
+	template<size_t tileSize, size_t... axisExtents>
+	struct TiledExtents
+	{
+		static_assert(tileSize != 0 && ((axisExtents % tileSize == 0) && ...), "Every extent must be a multiple of the tile size.");
+
+		static constexpr bool fixed = true;
+		static constexpr size_t dimensions = sizeof...(axisExtents);
+		static constexpr size_t extents[dimensions] = {axisExtents...};
+		static constexpr size_t points = (1 * ... * axisExtents);
+		static constexpr size_t fixedPoints = points;
+		static constexpr size_t smallestExtent = std::min({axisExtents...});
+		static constexpr bool rowMajor = false;
+		static constexpr uint32_t pointOrder = 1;
+		static constexpr size_t tile = tileSize;
+		static constexpr size_t tilePoints = Template_Power<tileSize, dimensions>::value;
+
+		//distance between neighbouring tiles along axis
+		static constexpr size_t tileStride(size_t axis)
+		{
+			size_t output = tilePoints;
+			for (size_t i = axis + 1; i < dimensions; ++i)
+			{
+				output *= extents[i] / tileSize;
+			}
+			return output;
+		}
+
+		//distance between neighbouring points along axis inside a tile
+		static constexpr size_t innerStride(size_t axis)
+		{
+			size_t output = 1;
+			for (size_t i = axis + 1; i < dimensions; ++i)
+			{
+				output *= tileSize;
+			}
+			return output;
+		}
+
+		//distance between neighbouring points along axis when both are in the same tile
+		static constexpr size_t stride(size_t axis)
+		{
+			return innerStride(axis);
+		}
+
+		static constexpr size_t index(const std::array<size_t, dimensions>& position)
+		{
+			size_t output = 0;
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				output += position[axis] / tileSize * tileStride(axis) + position[axis] % tileSize * innerStride(axis);
+			}
+			return output;
+		}
+
+		static constexpr size_t coordinate(size_t point, size_t axis)
+		{
+			return point / tileStride(axis) % (extents[axis] / tileSize) * tileSize + point / innerStride(axis) % tileSize;
+		}
+
+		static constexpr size_t moveTo(size_t point, size_t axis, size_t target)
+		{
+			size_t current = coordinate(point, axis);
+			return point - current / tileSize * tileStride(axis) - current % tileSize * innerStride(axis)
+				+ target / tileSize * tileStride(axis) + target % tileSize * innerStride(axis);
+		}
+	};
+
+	//grid stored in Z (Morton) order: the bits of the coordinates are interleaved, so points close
+	//along any axis are close in memory at every scale. all extents must be the same power of two.
+	template<size_t... axisExtents>
+	struct MortonExtents
+	{
+		static constexpr size_t dimensions = sizeof...(axisExtents);
+		static constexpr size_t side = std::max({axisExtents...});
+		static_assert(((axisExtents == side) && ...) && (side & (side - 1)) == 0, "Morton order needs the same power of two extent on every axis.");
+
+		static constexpr bool fixed = true;
+		static constexpr size_t extents[dimensions] = {axisExtents...};
+		static constexpr size_t points = (1 * ... * axisExtents);
+		static constexpr size_t fixedPoints = points;
+		static constexpr size_t smallestExtent = side;
+		static constexpr bool rowMajor = false;
+		static constexpr uint32_t pointOrder = 2;
+		static constexpr size_t tile = 0;
+
+		static constexpr size_t bits()
+		{
+			size_t output = 0;
+			while ((size_t(1) << output) < side)
+			{
+				++output;
+			}
+			return output;
+		}
+
+		//bit b of the coordinate along axis is bit b * dimensions + dimensions - 1 - axis of the index
+		static constexpr size_t spread(size_t value, size_t axis)
+		{
+			size_t output = 0;
+			for (size_t b = 0; b < bits(); ++b)
+			{
+				output |= (value >> b & 1) << (b * dimensions + dimensions - 1 - axis);
+			}
+			return output;
+		}
+
+		static constexpr size_t index(const std::array<size_t, dimensions>& position)
+		{
+			size_t output = 0;
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				output |= spread(position[axis], axis);
+			}
+			return output;
+		}
+
+		static constexpr size_t coordinate(size_t point, size_t axis)
+		{
+			size_t output = 0;
+			for (size_t b = 0; b < bits(); ++b)
+			{
+				output |= (point >> (b * dimensions + dimensions - 1 - axis) & 1) << b;
+			}
+			return output;
+		}
+
+		static constexpr size_t moveTo(size_t point, size_t axis, size_t target)
+		{
+			return (point & ~spread(side - 1, axis)) | spread(target, axis);
+		}
+	};
+
+	//throws std::invalid_argument with message unless the two grids have the same extents
+	//(compile time grids of one type always do)
+	template<typename Grid>
+	void checkSameExtents(const Grid& a, const Grid& b, const char* message)
+	{
+		if constexpr (!Grid::fixed)
+		{
+			if (!std::equal(a.extents, a.extents + Grid::dimensions, b.extents))
+			{
+				throw std::invalid_argument(message);
+			}
+		}
+	}
+
+	namespace
+	{
+		//Uniform_Extents T is the Extents with divisions points along each of dimensions axes
+
+		template<size_t dimensions, size_t divisions, typename = std::make_index_sequence<dimensions>>
+		struct Uniform_Extents;
+
+		template<size_t dimensions, size_t divisions, size_t... axes>
+		struct Uniform_Extents<dimensions, divisions, std::index_sequence<axes...>>
+		{
+			typedef Extents<((void)axes, divisions)...> T;
+		};
+	}
+
+}
@@ -0,0 +1,206 @@
+namespace SimulationUtilities{
+
+	namespace
+	{
+		//Cash-Karp embedded runge kutta coefficients (numerical recipes, same names as Python_Utils/rk4_code.py)
+		struct CashKarpTableau
+		{
+			//fraction time coefficients
+			static constexpr double a2 = 1.0 / 5;
+			static constexpr double a3 = 3.0 / 10;
+			static constexpr double a4 = 3.0 / 5;
+			static constexpr double a5 = 1;
+			static constexpr double a6 = 7.0 / 8;
+
+			//previous value weights
+			static constexpr double b21 = 1.0 / 5;
+
+			static constexpr double b31 = 3.0 / 40;
+			static constexpr double b32 = 9.0 / 40;
+
+			static constexpr double b41 = 3.0 / 10;
+			static constexpr double b42 = -9.0 / 10;
+			static constexpr double b43 = 6.0 / 5;
+
+			static constexpr double b51 = -11.0 / 54;
+			static constexpr double b52 = 5.0 / 2;
+			static constexpr double b53 = -70.0 / 27;
+			static constexpr double b54 = 35.0 / 27;
+
+			static constexpr double b61 = 1631.0 / 55296;
+			static constexpr double b62 = 175.0 / 512;
+			static constexpr double b63 = 575.0 / 13824;
+			static constexpr double b64 = 44275.0 / 110592;
+			static constexpr double b65 = 253.0 / 4096;
+
+			//fifth order coefs (c2 = c5 = 0)
+			static constexpr double c1 = 37.0 / 378;
+			static constexpr double c3 = 250.0 / 621;
+			static constexpr double c4 = 125.0 / 594;
+			static constexpr double c6 = 512.0 / 1771;
+
+			//fourth order minus fifth order coefs (d2 = 0)
+			static constexpr double d1 = 2825.0 / 27648 - c1;
+			static constexpr double d3 = 18575.0 / 48384 - c3;
+			static constexpr double d4 = 13525.0 / 55296 - c4;
+			static constexpr double d5 = 277.0 / 14336;
+			static constexpr double d6 = 1.0 / 4 - c6;
+		};
+	}
+
+	//embedded RK45 (Cash-Karp) integrator for any state with a copy constructor and linearCombination
+	//(double, Tensor, DirectSum, TensorField, ...). every intermediate state lives in buffers
+	//made once in the constructor, so a step does not allocate, and each stage is one linearCombination sweep.
+	//the derivative is called as derivative(const State& state, double t, State& output) and
+	//has to overwrite output. the error functor is called as error(newState, deltaState, derivative, dt)
+	//and returns the ratio of the estimated error to the allowed error (a step is kept when <= 1).
+	template<typename State>
+	class CashKarpIntegrator
+	{
+		typedef CashKarpTableau K;
+
+		//ds1..ds6 hold the derivative at the six stages (ds1, at the start of the step, is kept
+		//through rejected steps). dt is folded into the stage weights instead of scaling them.
+		State ds1, ds2, ds3, ds4, ds5, ds6;
+		//stage input, then the fifth order result
+		State stage;
+		//fourth order minus fifth order result (the embedded error estimate)
+		State deltaState;
+
+		//stages two to six from ds1 and the error estimate in deltaState
+		template<typename Derivative>
+		void stages(const State& state, Derivative&& derivative, double t, double dt)
+		{
+			linearCombination(stage, {1, K::b21 * dt}, {&state, &ds1});
+			derivative(stage, t + K::a2 * dt, ds2);
+
+			linearCombination(stage, {1, K::b31 * dt, K::b32 * dt}, {&state, &ds1, &ds2});
+			derivative(stage, t + K::a3 * dt, ds3);
+
+			linearCombination(stage, {1, K::b41 * dt, K::b42 * dt, K::b43 * dt}, {&state, &ds1, &ds2, &ds3});
+			derivative(stage, t + K::a4 * dt, ds4);
+
+			linearCombination(stage, {1, K::b51 * dt, K::b52 * dt, K::b53 * dt, K::b54 * dt}, {&state, &ds1, &ds2, &ds3, &ds4});
+			derivative(stage, t + K::a5 * dt, ds5);
+
+			linearCombination(stage, {1, K::b61 * dt, K::b62 * dt, K::b63 * dt, K::b64 * dt, K::b65 * dt},
+				{&state, &ds1, &ds2, &ds3, &ds4, &ds5});
+			derivative(stage, t + K::a6 * dt, ds6);
+
+			linearCombination(deltaState, {K::d1 * dt, K::d3 * dt, K::d4 * dt, K::d5 * dt, K::d6 * dt}, {&ds1, &ds3, &ds4, &ds5, &ds6});
+		}
+
+		//output = the fifth order result (output may be state)
+		void fifthOrder(State& output, const State& state, double dt)
+		{
+			linearCombination(output, {1, K::c1 * dt, K::c3 * dt, K::c4 * dt, K::c6 * dt}, {&state, &ds1, &ds3, &ds4, &ds6});
+		}
+	public:
+		//number of times a step is shrunk before fullStep gives up (a fail safe, as in rk4_code.py)
+		size_t maxAttempts = 20;
+
+		//the prototype gives the shape of the buffers (grid size for run time grids), its values are not used
+		CashKarpIntegrator(const State& prototype)
+		:
+			ds1(prototype), ds2(prototype), ds3(prototype), ds4(prototype), ds5(prototype), ds6(prototype),
+			stage(prototype), deltaState(prototype)
+		{}
+
+		//one fixed size step. state is advanced in place: its storage is written, never swapped
+		//for a scratch buffer, so pointers into it (getData()) stay valid across steps.
+		template<typename Derivative>
+		void step(State& state, Derivative&& derivative, double t, double dt)
+		{
+			derivative(state, t, ds1);
+			stages(state, derivative, t, dt);
+			fifthOrder(state, state, dt);
+		}
+
+		//one adaptive step. on success state (in place, as in step) and t are advanced, dt is set to
+		//the suggested next step size and true is returned. if the error stays above tolerance for maxAttempts tries
+		//nothing is advanced, dt is the last (shrunk) step size and false is returned.
+		//the derivative at the start is only evaluated once, however many tries are needed.
+		template<typename Derivative, typename Error>
+		bool fullStep(State& state, Derivative&& derivative, Error&& error, double& t, double& dt)
+		{
+			derivative(state, t, ds1);
+			for (size_t attempt = 0; attempt < maxAttempts; ++attempt)
+			{
+				stages(state, derivative, t, dt);
+				fifthOrder(stage, state, dt);
+				double ds = error((const State&)stage, (const State&)deltaState, (const State&)ds1, dt);
+				if (ds <= 1)
+				{
+					t += dt;
+					//copied rather than swapped, so the caller's state keeps its storage
+					linearCombination(state, {1}, {&stage});
+					//0.9 gives some wiggle room so the next step is not right at the tolerance,
+					//growth is capped at 5 times (as numerical recipes does) so ds = 0 is safe
+					dt *= std::min(0.9 * std::pow(ds, -1.0 / 5), 5.0);
+					return true;
+				}
+				dt *= std::max(0.9 * std::pow(ds, -1.0 / 4), 0.1);
+			}
+			return false;
+		}
+
+		//integrates from t0 to t1 (the last step is cut to land on t1), calling
+		//observer(state, t) after every accepted step. returns false if a step failed.
+		template<typename Derivative, typename Error, typename Observer>
+		bool integrate(State& state, Derivative&& derivative, Error&& error, double t0, double t1, double dt, Observer&& observer)
+		{
+			double t = t0;
+			while (t < t1)
+			{
+				double stepDt = std::min(dt, t1 - t);
+				bool lastStep = stepDt < dt;
+				if (!fullStep(state, derivative, error, t, stepDt))
+				{
+					return false;
+				}
+				//a cut final step should not shrink the suggested step size
+				if (!lastStep)
+				{
+					dt = stepDt;
+				}
+				observer((const State&)state, t);
+			}
+			return true;
+		}
+
+		template<typename Derivative, typename Error>
+		bool integrate(State& state, Derivative&& derivative, Error&& error, double t0, double t1, double dt)
+		{
+			auto ignore = [](const State&, double){};
+			return integrate(state, derivative, error, t0, t1, dt, ignore);
+		}
+
+		//fixed step size version of integrate (the last step is cut to land on t1)
+		template<typename Derivative, typename Observer>
+		void integrateFixed(State& state, Derivative&& derivative, double t0, double t1, double dt, Observer&& observer)
+		{
+			double t = t0;
+			while (t < t1)
+			{
+				double stepDt = std::min(dt, t1 - t);
+				step(state, derivative, t, stepDt);
+				t += stepDt;
+				observer((const State&)state, t);
+			}
+		}
+
+		template<typename Derivative>
+		void integrateFixed(State& state, Derivative&& derivative, double t0, double t1, double dt)
+		{
+			auto ignore = [](const State&, double){};
+			integrateFixed(state, derivative, t0, t1, dt, ignore);
+		}
+
+		//fourth order minus fifth order result of the last step
+		const State& getDeltaState() const
+		{
+			return deltaState;
+		}
+	};
+
+}
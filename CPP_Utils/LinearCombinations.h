@@ -0,0 +1,167 @@
+namespace SimulationUtilities{
+
+	namespace
+	{
+		//output = sum of weights[k] * *inputs[k]. overloads for the types with flat storage sweep
+		//every input once, DirectSums recurse into their members with the same weights.
+
+		template<typename State, size_t count>
+		void linearCombinationKernel(State& output, const std::array<double, count>& weights,
+			const std::array<const State*, count>& inputs);
+
+		template<size_t dimensions, size_t rank, typename T, size_t count>
+		void linearCombinationKernel(Tensor<dimensions, rank, T>& output, const std::array<double, count>& weights,
+			const std::array<const Tensor<dimensions, rank, T>*, count>& inputs);
+
+		template<size_t dimensions, size_t rank, typename Symmetry, typename T, size_t count>
+		void linearCombinationKernel(PackedTensor<dimensions, rank, Symmetry, T>& output, const std::array<double, count>& weights,
+			const std::array<const PackedTensor<dimensions, rank, Symmetry, T>*, count>& inputs);
+
+		template<typename Grid, size_t rank, typename T, typename Layout, typename Symmetry, size_t count>
+		void linearCombinationKernel(GridTensorField<Grid, rank, T, Layout, Symmetry>& output, const std::array<double, count>& weights,
+			const std::array<const GridTensorField<Grid, rank, T, Layout, Symmetry>*, count>& inputs);
+
+		template<typename... VectorTypes, size_t count>
+		void linearCombinationKernel(DirectSum<VectorTypes...>& output, const std::array<double, count>& weights,
+			const std::array<const DirectSum<VectorTypes...>*, count>& inputs);
+
+		//anything else (double, ...) uses its own + and *
+		template<typename State, size_t count, size_t... Is>
+		void linearCombinationFold(State& output, const std::array<double, count>& weights,
+			const std::array<const State*, count>& inputs, std::index_sequence<Is...>)
+		{
+			output = ((*inputs[Is] * weights[Is]) + ...);
+		}
+
+		template<typename State, size_t count>
+		void linearCombinationKernel(State& output, const std::array<double, count>& weights,
+			const std::array<const State*, count>& inputs)
+		{
+			linearCombinationFold(output, weights, inputs, std::make_index_sequence<count>());
+		}
+
+		template<typename T, size_t count>
+		std::array<T, count> scalarWeights(const std::array<double, count>& weights)
+		{
+			std::array<T, count> output;
+			std::copy(weights.begin(), weights.end(), output.begin());
+			return output;
+		}
+
+		template<size_t dimensions, size_t rank, typename T, size_t count>
+		void linearCombinationKernel(Tensor<dimensions, rank, T>& output, const std::array<double, count>& weights,
+			const std::array<const Tensor<dimensions, rank, T>*, count>& inputs)
+		{
+			std::array<const T*, count> data;
+			for (size_t k = 0; k < count; ++k)
+			{
+				data[k] = inputs[k]->getData();
+			}
+			simdLinearCombination<count>(output.getData(), data, scalarWeights<T>(weights), Template_Power<dimensions, rank>::value);
+		}
+
+		template<size_t dimensions, size_t rank, typename Symmetry, typename T, size_t count>
+		void linearCombinationKernel(PackedTensor<dimensions, rank, Symmetry, T>& output, const std::array<double, count>& weights,
+			const std::array<const PackedTensor<dimensions, rank, Symmetry, T>*, count>& inputs)
+		{
+			std::array<const T*, count> data;
+			for (size_t k = 0; k < count; ++k)
+			{
+				data[k] = inputs[k]->getData();
+			}
+			simdLinearCombination<count>(output.getData(), data, scalarWeights<T>(weights), output.components);
+		}
+
+		//the fields are treated as flat scalar buffers (they share grid and layout), split across the parallel execution threads
+		template<typename Grid, size_t rank, typename T, typename Layout, typename Symmetry, size_t count>
+		void linearCombinationKernel(GridTensorField<Grid, rank, T, Layout, Symmetry>& output, const std::array<double, count>& weights,
+			const std::array<const GridTensorField<Grid, rank, T, Layout, Symmetry>*, count>& inputs)
+		{
+			if constexpr (!Grid::fixed)
+			{
+				const Grid& grid = inputs[0]->getGrid();
+				for (size_t k = 1; k < count; ++k)
+				{
+					if (!std::equal(grid.extents, grid.extents + Grid::dimensions, inputs[k]->getGrid().extents))
+					{
+						throw std::invalid_argument("linearCombination inputs must be on the same grid.");
+					}
+				}
+				if (!std::equal(grid.extents, grid.extents + Grid::dimensions, output.getGrid().extents))
+				{
+					output = GridTensorField<Grid, rank, T, Layout, Symmetry>(grid);
+				}
+			}
+			std::array<const T*, count> data;
+			for (size_t k = 0; k < count; ++k)
+			{
+				data[k] = inputs[k]->getData();
+			}
+			std::array<T, count> fieldWeights = scalarWeights<T>(weights);
+			T* outputData = output.getData();
+			parallelFor(output.size() * Symmetry_Storage<Grid::dimensions, rank, Symmetry>::components, [&](size_t begin, size_t end)
+			{
+				std::array<const T*, count> block;
+				for (size_t k = 0; k < count; ++k)
+				{
+					block[k] = data[k] + begin;
+				}
+				simdLinearCombination<count>(outputData + begin, block, fieldWeights, end - begin);
+			});
+		}
+
+		template<size_t I, typename... VectorTypes, size_t count>
+		auto memberPointers(const std::array<const DirectSum<VectorTypes...>*, count>& inputs)
+		{
+			std::array<const std::tuple_element_t<I, std::tuple<VectorTypes...>>*, count> output;
+			for (size_t k = 0; k < count; ++k)
+			{
+				output[k] = &get<I>(*inputs[k]);
+			}
+			return output;
+		}
+
+		template<typename... VectorTypes, size_t count, size_t... Is>
+		void linearCombinationDirectSum(DirectSum<VectorTypes...>& output, const std::array<double, count>& weights,
+			const std::array<const DirectSum<VectorTypes...>*, count>& inputs, std::index_sequence<Is...>)
+		{
+			(linearCombinationKernel(getReference<Is>(output), weights, memberPointers<Is>(inputs)), ...);
+		}
+
+		template<typename... VectorTypes, size_t count>
+		void linearCombinationKernel(DirectSum<VectorTypes...>& output, const std::array<double, count>& weights,
+			const std::array<const DirectSum<VectorTypes...>*, count>& inputs)
+		{
+			linearCombinationDirectSum(output, weights, inputs, std::index_sequence_for<VectorTypes...>());
+		}
+	}
+
+	//output = weights[0] * *inputs[0] + weights[1] * *inputs[1] + ..., e.g.
+	//linearCombination(stage, {1, b51 * dt, b52 * dt, b53 * dt, b54 * dt}, {&state, &ds1, &ds2, &ds3, &ds4})
+	//fields (also inside DirectSums) are computed in one sweep that reads every input once,
+	//without temporaries. output may also be one of the inputs.
+	template<typename State, size_t count>
+	void linearCombination(State& output, const double (&weights)[count], const State* const (&inputs)[count])
+	{
+		std::array<double, count> weightArray;
+		std::array<const State*, count> inputArray;
+		std::copy(weights, weights + count, weightArray.begin());
+		std::copy(inputs, inputs + count, inputArray.begin());
+		linearCombinationKernel(output, weightArray, inputArray);
+	}
+
+	//y = a * x + y
+	template<typename State>
+	void axpy(double a, const State& x, State& y)
+	{
+		linearCombination(y, {a, 1}, {&x, &y});
+	}
+
+	//y = a * x + b * y
+	template<typename State>
+	void axpby(double a, const State& x, double b, State& y)
+	{
+		linearCombination(y, {a, b}, {&x, &y});
+	}
+
+}
@@ -0,0 +1,257 @@
+namespace SimulationUtilities{
+
+	//how parallelFor hands out work. Static gives each thread one contiguous block,
+	//Dynamic has threads take chunkSize blocks from a shared counter until none are left.
+	enum class Schedule{Static, Dynamic};
+
+	//fixed set of worker threads. run() executes a job on every worker and the calling
+	//thread (each gets its own thread number) and returns once all of them have finished.
+	//if the job throws on any thread, run() still waits for every thread, then rethrows
+	//the first exception.
+	class ThreadPool
+	{
+		std::vector<std::thread> workers;
+		std::mutex runLock;
+		std::mutex lock;
+		std::condition_variable wake;
+		std::condition_variable finished;
+		//current job, called as invoke(context, threadNumber) (no std::function so run() does not allocate)
+		void (*invoke)(const void*, size_t) = nullptr;
+		const void* context = nullptr;
+		size_t generation = 0;
+		size_t remaining = 0;
+		bool stopping = false;
+		//first exception a worker threw in the current job
+		std::exception_ptr error;
+
+		void work(size_t threadNumber)
+		{
+			size_t seenGeneration = 0;
+			std::unique_lock<std::mutex> guard(lock);
+			while (true)
+			{
+				wake.wait(guard, [&]{return stopping || generation != seenGeneration;});
+				if (stopping)
+				{
+					return;
+				}
+				seenGeneration = generation;
+				void (*currentInvoke)(const void*, size_t) = invoke;
+				const void* currentContext = context;
+				guard.unlock();
+				std::exception_ptr thrown;
+				try
+				{
+					currentInvoke(currentContext, threadNumber);
+				}
+				catch (...)
+				{
+					thrown = std::current_exception();
+				}
+				guard.lock();
+				if (thrown && !error)
+				{
+					error = thrown;
+				}
+				if (--remaining == 0)
+				{
+					finished.notify_one();
+				}
+			}
+		}
+	public:
+		ThreadPool(size_t threadCount)
+		{
+			for (size_t i = 1; i < threadCount; ++i)
+			{
+				workers.emplace_back(&ThreadPool::work, this, i);
+			}
+		}
+
+		ThreadPool(const ThreadPool& other) = delete;
+		ThreadPool& operator=(const ThreadPool& other) = delete;
+
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				stopping = true;
+			}
+			wake.notify_all();
+			for (auto& worker : workers)
+			{
+				worker.join();
+			}
+		}
+
+		//number of threads taking part in run(), the caller included
+		size_t size() const
+		{
+			return workers.size() + 1;
+		}
+
+		template<typename Job>
+		void run(const Job& newJob)
+		{
+			std::lock_guard<std::mutex> runGuard(runLock);
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				invoke = [](const void* jobContext, size_t threadNumber)
+				{
+					(*(const Job*)jobContext)(threadNumber);
+				};
+				context = &newJob;
+				remaining = workers.size();
+				++generation;
+			}
+			wake.notify_all();
+			std::exception_ptr thrown;
+			try
+			{
+				newJob(0);
+			}
+			catch (...)
+			{
+				thrown = std::current_exception();
+			}
+			std::unique_lock<std::mutex> guard(lock);
+			finished.wait(guard, [&]{return remaining == 0;});
+			invoke = nullptr;
+			context = nullptr;
+			if (!thrown)
+			{
+				thrown = error;
+			}
+			error = nullptr;
+			guard.unlock();
+			if (thrown)
+			{
+				std::rethrow_exception(thrown);
+			}
+		}
+
+		//calls body(begin, end) over disjoint ranges covering [0, count)
+		template<typename Body>
+		void parallelFor(size_t count, const Body& body, Schedule schedule, size_t chunkSize)
+		{
+			size_t threads = size();
+			if (schedule == Schedule::Static)
+			{
+				run([&](size_t threadNumber)
+				{
+					size_t begin = count * threadNumber / threads;
+					size_t end = count * (threadNumber + 1) / threads;
+					if (begin < end)
+					{
+						body(begin, end);
+					}
+				});
+			}
+			else
+			{
+				chunkSize = std::max<size_t>(chunkSize, 1);
+				std::atomic<size_t> next(0);
+				run([&](size_t)
+				{
+					for (size_t begin = next.fetch_add(chunkSize); begin < count; begin = next.fetch_add(chunkSize))
+					{
+						body(begin, std::min(begin + chunkSize, count));
+					}
+				});
+			}
+		}
+	};
+
+	//process wide state. these are plain inline (not in an anonymous namespace) so every
+	//translation unit shares one pool and one set of settings.
+	struct ParallelSettings
+	{
+		size_t threads = 1;
+		Schedule schedule = Schedule::Static;
+		size_t chunkSize = 4096;
+		std::unique_ptr<ThreadPool> pool;
+	};
+
+	inline ParallelSettings& parallelSettings()
+	{
+		static ParallelSettings settings;
+		return settings;
+	}
+
+	//true on a thread that is already inside a parallel loop, so nested loops run serially
+	inline bool& insideParallelLoop()
+	{
+		thread_local bool inside = false;
+		return inside;
+	}
+
+	namespace
+	{
+		//sets insideParallelLoop() for its lifetime and restores it, also when the loop body throws
+		class ParallelLoopScope
+		{
+			bool& inside;
+			bool wasInside;
+		public:
+			ParallelLoopScope()
+			:
+				inside(insideParallelLoop()),
+				wasInside(inside)
+			{
+				inside = true;
+			}
+
+			ParallelLoopScope(const ParallelLoopScope& other) = delete;
+			ParallelLoopScope& operator=(const ParallelLoopScope& other) = delete;
+
+			~ParallelLoopScope()
+			{
+				inside = wasInside;
+			}
+		};
+	}
+
+	//selects how field assignments and compound operators are evaluated.
+	//threads = 1 (the default) is serial, threads = 0 uses every hardware thread.
+	//chunkSize is the number of grid points (or scalars) in one Dynamic block.
+	//results do not depend on these settings since every element is computed independently.
+	inline void setParallelExecution(size_t threads, Schedule schedule = Schedule::Static, size_t chunkSize = 4096)
+	{
+		if (threads == 0)
+		{
+			threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		}
+		ParallelSettings& settings = parallelSettings();
+		if (threads != settings.threads)
+		{
+			settings.pool.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
+		}
+		settings.threads = threads;
+		settings.schedule = schedule;
+		settings.chunkSize = chunkSize;
+	}
+
+	inline size_t parallelThreadCount()
+	{
+		return parallelSettings().threads;
+	}
+
+	//runs body(begin, end) over [0, count) with the current parallel execution settings.
+	//an exception thrown by body on any thread is rethrown here once every thread has stopped.
+	template<typename Body>
+	void parallelFor(size_t count, const Body& body)
+	{
+		ParallelSettings& settings = parallelSettings();
+		if (!settings.pool || insideParallelLoop() || count < 2)
+		{
+			body(0, count);
+			return;
+		}
+		settings.pool->parallelFor(count, [&](size_t begin, size_t end)
+		{
+			ParallelLoopScope scope;
+			body(begin, end);
+		}, settings.schedule, settings.chunkSize);
+	}
+
+}
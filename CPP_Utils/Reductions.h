@@ -0,0 +1,280 @@
+namespace SimulationUtilities{
+
+	namespace
+	{
+		//scalars are reduced in fixed blocks of reductionBlock, each with reductionLanes running
+		//partial results. the blocks are then combined pairwise in a fixed tree, so a result only
+		//depends on the data (and the SIMD target), never on the parallel execution settings.
+		static constexpr size_t reductionBlock = 4096;
+		static constexpr size_t reductionLanes = 8;
+
+		struct Reduce_Sum
+		{
+			template<typename S>
+			static inline S identity(){return S();}
+			template<typename S>
+			static inline S combine(S left, S right){return left + right;}
+		};
+
+		struct Reduce_Min
+		{
+			template<typename S>
+			static inline S identity(){return std::numeric_limits<S>::max();}
+			template<typename S>
+			static inline S combine(S left, S right){return right < left ? right : left;}
+		};
+
+		struct Reduce_Max
+		{
+			template<typename S>
+			static inline S identity(){return std::numeric_limits<S>::lowest();}
+			template<typename S>
+			static inline S combine(S left, S right){return right > left ? right : left;}
+		};
+
+		//values[0] + ... + values[count - 1] as a balanced tree (count > 0)
+		template<typename Reducer, typename S>
+		S combineTree(const S* values, size_t count)
+		{
+			if (count == 1)
+			{
+				return values[0];
+			}
+			size_t half = count / 2;
+			return Reducer::combine(combineTree<Reducer>(values, half), combineTree<Reducer>(values + half, count - half));
+		}
+
+		//combines term(data[i]...) over count scalars of every data buffer, blocks on the parallel execution threads
+		template<typename Reducer, typename S, typename Term, typename... Ts>
+		S reduceFlat(size_t count, const Term& term, const Ts*... data)
+		{
+			size_t blocks = (count + reductionBlock - 1) / reductionBlock;
+			if (blocks == 0)
+			{
+				return Reducer::template identity<S>();
+			}
+			std::shared_ptr<S[]> partials = pooledArray<S>(blocks, false);
+			S* partialData = partials.get();
+			parallelFor(blocks, [&](size_t firstBlock, size_t endBlock)
+			{
+				for (size_t block = firstBlock; block < endBlock; ++block)
+				{
+					size_t begin = block * reductionBlock;
+					size_t end = std::min(begin + reductionBlock, count);
+					S lanes[reductionLanes];
+					std::fill(lanes, lanes + reductionLanes, Reducer::template identity<S>());
+					size_t i = begin;
+					for (; i + reductionLanes <= end; i += reductionLanes)
+					{
+						for (size_t lane = 0; lane < reductionLanes; ++lane)
+						{
+							lanes[lane] = Reducer::combine(lanes[lane], S(term(S(data[i + lane])...)));
+						}
+					}
+					for (size_t lane = 0; i < end; ++i, ++lane)
+					{
+						lanes[lane] = Reducer::combine(lanes[lane], S(term(S(data[i])...)));
+					}
+					partialData[block] = combineTree<Reducer>(lanes, reductionLanes);
+				}
+			});
+			return combineTree<Reducer>(partialData, blocks);
+		}
+
+		//reduceState combines term over every stored scalar of one or more states of the same type
+
+		template<typename Reducer, typename Term, typename T, typename... Others>
+		std::enable_if_t<std::is_arithmetic<T>::value, typename Template_Accumulator<T>::T>
+		reduceState(const Term& term, const T& first, const Others&... others)
+		{
+			typedef typename Template_Accumulator<T>::T S;
+			return S(term(S(first), S(others)...));
+		}
+
+		//fixed size states of at most one block: the same lanes and tree as one block of reduceFlat
+		//(so the result is identical), without the partials buffer or the parallel loop
+		template<typename Reducer, typename S, size_t count, typename Term, typename... Ts>
+		S reduceFixed(const Term& term, const Ts*... data)
+		{
+			if constexpr (count > reductionBlock)
+			{
+				return reduceFlat<Reducer, S>(count, term, data...);
+			}
+			else
+			{
+				S lanes[reductionLanes];
+				std::fill(lanes, lanes + reductionLanes, Reducer::template identity<S>());
+				for (size_t i = 0; i < count; ++i)
+				{
+					lanes[i % reductionLanes] = Reducer::combine(lanes[i % reductionLanes], S(term(S(data[i])...)));
+				}
+				return combineTree<Reducer>(lanes, reductionLanes);
+			}
+		}
+
+		template<typename Reducer, typename Term, size_t dimensions, size_t rank, typename T, typename... Others>
+		typename Template_Accumulator<T>::T reduceState(const Term& term, const Tensor<dimensions, rank, T>& first, const Others&... others)
+		{
+			return reduceFixed<Reducer, typename Template_Accumulator<T>::T, Template_Power<dimensions, rank>::value>(term,
+				first.getData(), others.getData()...);
+		}
+
+		template<typename Reducer, typename Term, size_t dimensions, size_t rank, typename Symmetry, typename T, typename... Others>
+		typename Template_Accumulator<T>::T reduceState(const Term& term, const PackedTensor<dimensions, rank, Symmetry, T>& first,
+			const Others&... others)
+		{
+			return reduceFixed<Reducer, typename Template_Accumulator<T>::T, PackedTensor<dimensions, rank, Symmetry, T>::components>(term,
+				first.getData(), others.getData()...);
+		}
+
+		template<typename Reducer, typename Term, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry, typename... Others>
+		typename Template_Accumulator<T>::T reduceState(const Term& term, const GridTensorField<Grid, rank, T, Layout, Symmetry>& first,
+			const Others&... others)
+		{
+			(checkSameExtents(first.getGrid(), others.getGrid(), "Reduced fields must be on the same grid."), ...);
+			return reduceFlat<Reducer, typename Template_Accumulator<T>::T>(
+				first.size() * Symmetry_Storage<Grid::dimensions, rank, Symmetry>::components, term, first.getData(), others.getData()...);
+		}
+
+		template<typename Reducer, typename S>
+		S combineMembers(S value)
+		{
+			return value;
+		}
+
+		template<typename Reducer, typename S1, typename S2, typename... Rest>
+		auto combineMembers(S1 first, S2 second, Rest... rest)
+		{
+			typedef std::common_type_t<S1, S2> S;
+			return combineMembers<Reducer>(Reducer::combine(S(first), S(second)), rest...);
+		}
+
+		template<typename Reducer, typename Term, typename... VectorTypes, typename... Others>
+		auto reduceState(const Term& term, const DirectSum<VectorTypes...>& first, const Others&... others);
+
+		template<typename Reducer, size_t I, typename Term, typename... VectorTypes, typename... Others>
+		auto reduceMember(const Term& term, const DirectSum<VectorTypes...>& first, const Others&... others)
+		{
+			return reduceState<Reducer>(term, get<I>(first), get<I>(others)...);
+		}
+
+		template<typename Reducer, typename Term, size_t... Is, typename... VectorTypes, typename... Others>
+		auto reduceMembers(const Term& term, std::index_sequence<Is...>, const DirectSum<VectorTypes...>& first, const Others&... others)
+		{
+			return combineMembers<Reducer>(reduceMember<Reducer, Is>(term, first, others...)...);
+		}
+
+		//the members of a DirectSum are reduced in order and their results combined left to right
+		template<typename Reducer, typename Term, typename... VectorTypes, typename... Others>
+		auto reduceState(const Term& term, const DirectSum<VectorTypes...>& first, const Others&... others)
+		{
+			return reduceMembers<Reducer>(term, std::index_sequence_for<VectorTypes...>(), first, others...);
+		}
+
+		//number of stored scalars
+
+		template<typename T>
+		std::enable_if_t<std::is_arithmetic<T>::value, size_t> scalarCount(const T&)
+		{
+			return 1;
+		}
+
+		template<size_t dimensions, size_t rank, typename T>
+		size_t scalarCount(const Tensor<dimensions, rank, T>&)
+		{
+			return Template_Power<dimensions, rank>::value;
+		}
+
+		template<size_t dimensions, size_t rank, typename Symmetry, typename T>
+		size_t scalarCount(const PackedTensor<dimensions, rank, Symmetry, T>&)
+		{
+			return PackedTensor<dimensions, rank, Symmetry, T>::components;
+		}
+
+		template<typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+		size_t scalarCount(const GridTensorField<Grid, rank, T, Layout, Symmetry>& input)
+		{
+			return input.size() * Symmetry_Storage<Grid::dimensions, rank, Symmetry>::components;
+		}
+
+		template<typename... VectorTypes>
+		size_t scalarCount(const DirectSum<VectorTypes...>& input);
+
+		template<size_t... Is, typename... VectorTypes>
+		size_t scalarCountMembers(const DirectSum<VectorTypes...>& input, std::index_sequence<Is...>)
+		{
+			return (size_t(0) + ... + scalarCount(get<Is>(input)));
+		}
+
+		template<typename... VectorTypes>
+		size_t scalarCount(const DirectSum<VectorTypes...>& input)
+		{
+			return scalarCountMembers(input, std::index_sequence_for<VectorTypes...>());
+		}
+	}
+
+	//reductions over every stored scalar of a double, Tensor, PackedTensor, TensorField or DirectSum
+	//of them (a packed field counts each stored component once). fields are reduced on the
+	//parallel execution threads and the result is bitwise the same for any thread count.
+	//sums are carried in Template_Accumulator<T>::T (double for float with mixed precision).
+
+	template<typename State>
+	auto sumOf(const State& input)
+	{
+		return reduceState<Reduce_Sum>([](auto x){return x;}, input);
+	}
+
+	template<typename State>
+	auto dotProduct(const State& left, const State& right)
+	{
+		return reduceState<Reduce_Sum>([](auto x, auto y){return x * y;}, left, right);
+	}
+
+	template<typename State>
+	auto normL2(const State& input)
+	{
+		return std::sqrt(reduceState<Reduce_Sum>([](auto x){return x * x;}, input));
+	}
+
+	template<typename State>
+	auto normLInf(const State& input)
+	{
+		return reduceState<Reduce_Max>([](auto x){return std::abs(x);}, input);
+	}
+
+	template<typename State>
+	auto minimumOf(const State& input)
+	{
+		return reduceState<Reduce_Min>([](auto x){return x;}, input);
+	}
+
+	template<typename State>
+	auto maximumOf(const State& input)
+	{
+		return reduceState<Reduce_Max>([](auto x){return x;}, input);
+	}
+
+	//sqrt(mean((error / (absoluteTolerance + relativeTolerance * |reference|))^2)), the usual
+	//step size control norm: an integrator error functor returns it for (deltaState, newState).
+	template<typename State>
+	double weightedRmsNorm(const State& error, const State& reference, double absoluteTolerance, double relativeTolerance)
+	{
+		double sum = reduceState<Reduce_Sum>([=](auto e, auto y)
+		{
+			auto scaled = e / (absoluteTolerance + relativeTolerance * std::abs(y));
+			return scaled * scaled;
+		}, error, reference);
+		return std::sqrt(sum / std::max<size_t>(scalarCount(error), 1));
+	}
+
+	//max of |error| / (absoluteTolerance + relativeTolerance * |reference|) over every scalar
+	template<typename State>
+	double weightedMaxNorm(const State& error, const State& reference, double absoluteTolerance, double relativeTolerance)
+	{
+		return reduceState<Reduce_Max>([=](auto e, auto y)
+		{
+			return std::abs(e) / (absoluteTolerance + relativeTolerance * std::abs(y));
+		}, error, reference);
+	}
+
+}
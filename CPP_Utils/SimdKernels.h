@@ -0,0 +1,227 @@
+namespace SimulationUtilities{
+
+	namespace
+	{
+		//SimdRegister<T> wraps the widest vector register the compiler was allowed to use for T
+		//(AVX-512, then AVX/AVX2, then SSE2). width 1 means there is no vector path and the
+		//kernels below fall back to plain loops. define SIMULATION_UTILITIES_NO_SIMD to force this.
+
+		template<typename T>
+		struct SimdRegister
+		{
+			static constexpr size_t width = 1;
+		};
+
+	#if !defined(SIMULATION_UTILITIES_NO_SIMD) && defined(__AVX512F__)
+
+		template<>
+		struct SimdRegister<double>
+		{
+			typedef __m512d Type;
+			static constexpr size_t width = 8;
+			static inline Type load(const double* source){return _mm512_loadu_pd(source);}
+			static inline void store(double* destination, Type value){_mm512_storeu_pd(destination, value);}
+			static inline Type broadcast(double value){return _mm512_set1_pd(value);}
+			static inline Type add(Type left, Type right){return _mm512_add_pd(left, right);}
+			static inline Type subtract(Type left, Type right){return _mm512_sub_pd(left, right);}
+			static inline Type multiply(Type left, Type right){return _mm512_mul_pd(left, right);}
+			static inline Type divide(Type left, Type right){return _mm512_div_pd(left, right);}
+		};
+
+		template<>
+		struct SimdRegister<float>
+		{
+			typedef __m512 Type;
+			static constexpr size_t width = 16;
+			static inline Type load(const float* source){return _mm512_loadu_ps(source);}
+			static inline void store(float* destination, Type value){_mm512_storeu_ps(destination, value);}
+			static inline Type broadcast(float value){return _mm512_set1_ps(value);}
+			static inline Type add(Type left, Type right){return _mm512_add_ps(left, right);}
+			static inline Type subtract(Type left, Type right){return _mm512_sub_ps(left, right);}
+			static inline Type multiply(Type left, Type right){return _mm512_mul_ps(left, right);}
+			static inline Type divide(Type left, Type right){return _mm512_div_ps(left, right);}
+		};
+
+	#elif !defined(SIMULATION_UTILITIES_NO_SIMD) && (defined(__AVX2__) || defined(__AVX__))
+
+		template<>
+		struct SimdRegister<double>
+		{
+			typedef __m256d Type;
+			static constexpr size_t width = 4;
+			static inline Type load(const double* source){return _mm256_loadu_pd(source);}
+			static inline void store(double* destination, Type value){_mm256_storeu_pd(destination, value);}
+			static inline Type broadcast(double value){return _mm256_set1_pd(value);}
+			static inline Type add(Type left, Type right){return _mm256_add_pd(left, right);}
+			static inline Type subtract(Type left, Type right){return _mm256_sub_pd(left, right);}
+			static inline Type multiply(Type left, Type right){return _mm256_mul_pd(left, right);}
+			static inline Type divide(Type left, Type right){return _mm256_div_pd(left, right);}
+		};
+
+		template<>
+		struct SimdRegister<float>
+		{
+			typedef __m256 Type;
+			static constexpr size_t width = 8;
+			static inline Type load(const float* source){return _mm256_loadu_ps(source);}
+			static inline void store(float* destination, Type value){_mm256_storeu_ps(destination, value);}
+			static inline Type broadcast(float value){return _mm256_set1_ps(value);}
+			static inline Type add(Type left, Type right){return _mm256_add_ps(left, right);}
+			static inline Type subtract(Type left, Type right){return _mm256_sub_ps(left, right);}
+			static inline Type multiply(Type left, Type right){return _mm256_mul_ps(left, right);}
+			static inline Type divide(Type left, Type right){return _mm256_div_ps(left, right);}
+		};
+
+	#elif !defined(SIMULATION_UTILITIES_NO_SIMD) && defined(__SSE2__)
+
+		template<>
+		struct SimdRegister<double>
+		{
+			typedef __m128d Type;
+			static constexpr size_t width = 2;
+			static inline Type load(const double* source){return _mm_loadu_pd(source);}
+			static inline void store(double* destination, Type value){_mm_storeu_pd(destination, value);}
+			static inline Type broadcast(double value){return _mm_set1_pd(value);}
+			static inline Type add(Type left, Type right){return _mm_add_pd(left, right);}
+			static inline Type subtract(Type left, Type right){return _mm_sub_pd(left, right);}
+			static inline Type multiply(Type left, Type right){return _mm_mul_pd(left, right);}
+			static inline Type divide(Type left, Type right){return _mm_div_pd(left, right);}
+		};
+
+		template<>
+		struct SimdRegister<float>
+		{
+			typedef __m128 Type;
+			static constexpr size_t width = 4;
+			static inline Type load(const float* source){return _mm_loadu_ps(source);}
+			static inline void store(float* destination, Type value){_mm_storeu_ps(destination, value);}
+			static inline Type broadcast(float value){return _mm_set1_ps(value);}
+			static inline Type add(Type left, Type right){return _mm_add_ps(left, right);}
+			static inline Type subtract(Type left, Type right){return _mm_sub_ps(left, right);}
+			static inline Type multiply(Type left, Type right){return _mm_mul_ps(left, right);}
+			static inline Type divide(Type left, Type right){return _mm_div_ps(left, right);}
+		};
+
+	#endif
+
+		//element-wise operations, each with a vector and a scalar form
+
+		struct SimdAdd
+		{
+			template<typename Register, typename V>
+			static inline V vector(V left, V right){return Register::add(left, right);}
+			template<typename T>
+			static inline T scalar(T left, T right){return left + right;}
+		};
+
+		struct SimdSubtract
+		{
+			template<typename Register, typename V>
+			static inline V vector(V left, V right){return Register::subtract(left, right);}
+			template<typename T>
+			static inline T scalar(T left, T right){return left - right;}
+		};
+
+		struct SimdMultiply
+		{
+			template<typename Register, typename V>
+			static inline V vector(V left, V right){return Register::multiply(left, right);}
+			template<typename T>
+			static inline T scalar(T left, T right){return left * right;}
+		};
+
+		struct SimdDivide
+		{
+			template<typename Register, typename V>
+			static inline V vector(V left, V right){return Register::divide(left, right);}
+			template<typename T>
+			static inline T scalar(T left, T right){return left / right;}
+		};
+
+		//left[i] = Operation(left[i], right[i]) over count contiguous values
+
+		template<typename Operation, typename T>
+		inline void simdApply(T* left, const T* right, size_t count)
+		{
+			typedef SimdRegister<T> Register;
+			size_t i = 0;
+			if constexpr (Register::width > 1)
+			{
+				//whole registers end at vectorEnd, the scalar tail runs from there to count
+				size_t vectorEnd = count - count % Register::width;
+				for (; i < vectorEnd; i += Register::width)
+				{
+					Register::store(left + i, Operation::template vector<Register>(
+						Register::load(left + i), Register::load(right + i)));
+				}
+			}
+			for (; i < count; ++i)
+			{
+				left[i] = Operation::scalar(left[i], right[i]);
+			}
+		}
+
+		//left[i] = Operation(left[i], right) over count contiguous values
+
+		template<typename Operation, typename T>
+		inline void simdApply(T* left, T right, size_t count)
+		{
+			typedef SimdRegister<T> Register;
+			size_t i = 0;
+			if constexpr (Register::width > 1)
+			{
+				auto vectorRight = Register::broadcast(right);
+				size_t vectorEnd = count - count % Register::width;
+				for (; i < vectorEnd; i += Register::width)
+				{
+					Register::store(left + i, Operation::template vector<Register>(
+						Register::load(left + i), vectorRight));
+				}
+			}
+			for (; i < count; ++i)
+			{
+				left[i] = Operation::scalar(left[i], right);
+			}
+		}
+
+		//output[i] = sum of weights[k] * inputs[k][i] over count contiguous values, reading each input
+		//once. output may be one of the inputs.
+
+		template<size_t terms, typename T>
+		inline void simdLinearCombination(T* output, const std::array<const T*, terms>& inputs,
+			const std::array<T, terms>& weights, size_t count)
+		{
+			static_assert(terms != 0, "a linear combination needs at least one term.");
+			typedef SimdRegister<T> Register;
+			size_t i = 0;
+			if constexpr (Register::width > 1)
+			{
+				typename Register::Type vectorWeights[terms];
+				for (size_t k = 0; k < terms; ++k)
+				{
+					vectorWeights[k] = Register::broadcast(weights[k]);
+				}
+				size_t vectorEnd = count - count % Register::width;
+				for (; i < vectorEnd; i += Register::width)
+				{
+					typename Register::Type sum = Register::multiply(vectorWeights[0], Register::load(inputs[0] + i));
+					for (size_t k = 1; k < terms; ++k)
+					{
+						sum = Register::add(sum, Register::multiply(vectorWeights[k], Register::load(inputs[k] + i)));
+					}
+					Register::store(output + i, sum);
+				}
+			}
+			for (; i < count; ++i)
+			{
+				T sum = weights[0] * inputs[0][i];
+				for (size_t k = 1; k < terms; ++k)
+				{
+					sum += weights[k] * inputs[k][i];
+				}
+				output[i] = sum;
+			}
+		}
+	}
+
+}
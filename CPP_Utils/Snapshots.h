@@ -0,0 +1,161 @@
+namespace SimulationUtilities{
+
+	//what SnapshotWriter::submit does when every buffer is still waiting to be written
+	enum class SnapshotBackPressure{Block, Drop};
+
+	struct SnapshotStatistics
+	{
+		size_t written = 0;//snapshots written to disk
+		size_t dropped = 0;//snapshots skipped because every buffer was busy (Drop only)
+		size_t failed = 0;//snapshots whose file could not be written
+		size_t bytes = 0;//data bytes written
+		double stallSeconds = 0;//time submit spent waiting for a free buffer (Block only)
+		double writeSeconds = 0;//time the writer thread spent writing
+	};
+
+	//writes checkpoints of a state (TensorField, DirectSum, ...) on a background thread so the
+	//time loop does not wait for the disk. submit copies the state into one of queueDepth
+	//buffers (made once from the prototype, so a copy does not allocate) and returns, the
+	//writer thread saves the buffers in order to pathPrefix + step + ".bin" in the
+	//saveCheckpoint format. with queueDepth = 2 one snapshot is written while the next is taken.
+	template<typename State>
+	class SnapshotWriter
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		std::string pathPrefix;
+		size_t cadence;
+		SnapshotBackPressure backPressure;
+		size_t chunkBytes;
+
+		//buffer submitted % queueDepth is filled next, buffer written % queueDepth is saved next
+		std::vector<State> buffers;
+		std::vector<size_t> bufferSteps;
+		size_t submitted = 0;
+		size_t written = 0;
+		bool stopping = false;
+
+		std::mutex lock;
+		std::condition_variable filled;
+		std::condition_variable emptied;
+		SnapshotStatistics statistics;
+		std::thread writer;
+
+		void work()
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			while (true)
+			{
+				filled.wait(guard, [&]{return stopping || written < submitted;});
+				if (written == submitted)
+				{
+					return;
+				}
+				size_t index = written % buffers.size();
+				std::string path = pathPrefix + std::to_string(bufferSteps[index]) + ".bin";
+				guard.unlock();
+
+				Clock::time_point start = Clock::now();
+				std::vector<CheckpointRecord> records;
+				collectCheckpointRecords((const State&)buffers[index], records);
+				size_t bytes = 0;
+				for (const CheckpointRecord& record : records)
+				{
+					bytes += record.header.dataBytes;
+				}
+				std::ofstream file(path, std::ios::binary | std::ios::trunc);
+				bool success = file && writeCheckpointRecords(file, records, chunkBytes);
+				file.close();
+				success = success && !file.fail();
+				double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+				guard.lock();
+				statistics.writeSeconds += seconds;
+				if (success)
+				{
+					++statistics.written;
+					statistics.bytes += bytes;
+				}
+				else
+				{
+					++statistics.failed;
+				}
+				++written;
+				emptied.notify_all();
+			}
+		}
+	public:
+		//cadence n only takes every nth step passed to submit, chunkBytes is the largest single write
+		SnapshotWriter(const std::string& initPathPrefix, const State& prototype, size_t queueDepth = 2, size_t initCadence = 1,
+			SnapshotBackPressure initBackPressure = SnapshotBackPressure::Block, size_t initChunkBytes = 64 << 20)
+		:
+			pathPrefix(initPathPrefix),
+			cadence(std::max<size_t>(initCadence, 1)),
+			backPressure(initBackPressure),
+			chunkBytes(initChunkBytes),
+			buffers(std::max<size_t>(queueDepth, 1), prototype),
+			bufferSteps(buffers.size(), 0)
+		{
+			writer = std::thread(&SnapshotWriter::work, this);
+		}
+
+		SnapshotWriter(const SnapshotWriter& other) = delete;
+		SnapshotWriter& operator=(const SnapshotWriter& other) = delete;
+
+		//writes everything still queued before returning
+		~SnapshotWriter()
+		{
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				stopping = true;
+			}
+			filled.notify_one();
+			writer.join();
+		}
+
+		//queues a snapshot of state at step (skipped unless step is a multiple of the cadence).
+		//returns true if the snapshot was queued. meant to be called from one thread (the time loop).
+		bool submit(size_t step, const State& state)
+		{
+			if (step % cadence != 0)
+			{
+				return false;
+			}
+			std::unique_lock<std::mutex> guard(lock);
+			if (submitted - written == buffers.size())
+			{
+				if (backPressure == SnapshotBackPressure::Drop)
+				{
+					++statistics.dropped;
+					return false;
+				}
+				Clock::time_point start = Clock::now();
+				emptied.wait(guard, [&]{return submitted - written < buffers.size();});
+				statistics.stallSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+			}
+			size_t index = submitted % buffers.size();
+			//the writer thread does not touch this buffer until submitted is increased
+			guard.unlock();
+			buffers[index] = state;
+			bufferSteps[index] = step;
+			guard.lock();
+			++submitted;
+			filled.notify_one();
+			return true;
+		}
+
+		//waits until every queued snapshot has been written
+		void flush()
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			emptied.wait(guard, [&]{return written == submitted;});
+		}
+
+		SnapshotStatistics getStatistics()
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			return statistics;
+		}
+	};
+
+}
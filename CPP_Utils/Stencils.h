@@ -0,0 +1,760 @@
+namespace SimulationUtilities{
+
+	namespace
+	{
+		//exact finite difference weights of the derivative'th derivative on width consecutive points.
+		//weights of variant v are for the point v from the first one, coefficients[v][k] / denominator
+		//is the weight of point k. found from the Lagrange basis polynomials in integers.
+		template<size_t derivative, size_t width>
+		struct Finite_Difference_Weights
+		{
+			double denominator;
+			std::array<std::array<double, width>, width> coefficients;
+
+			static constexpr long long absolute(long long value)
+			{
+				return value < 0 ? -value : value;
+			}
+
+			static constexpr Finite_Difference_Weights build()
+			{
+				//weight of point k is numerators[v][k] / denominators[v][k]
+				long long numerators[width][width] = {};
+				long long denominators[width][width] = {};
+				long long common = 1;
+				for (size_t v = 0; v < width; ++v)
+				{
+					for (size_t k = 0; k < width; ++k)
+					{
+						//derivative at x = 0 of prod_{j != k} (x - x_j) / (x_k - x_j), with x_j = j - v.
+						//polynomial[p] is the coefficient of x^p of the numerator.
+						long long polynomial[width] = {1};
+						long long denominator = 1;
+						long long xk = (long long)k - (long long)v;
+						for (size_t j = 0; j < width; ++j)
+						{
+							if (j == k)
+							{
+								continue;
+							}
+							long long xj = (long long)j - (long long)v;
+							for (size_t p = width - 1; p > 0; --p)
+							{
+								polynomial[p] = polynomial[p - 1] - xj * polynomial[p];
+							}
+							polynomial[0] = -xj * polynomial[0];
+							denominator *= xk - xj;
+						}
+						long long numerator = polynomial[derivative] * (derivative == 2 ? 2 : 1);
+						long long divisor = std::gcd(absolute(numerator), absolute(denominator));
+						numerator /= divisor;
+						denominator /= divisor;
+						if (denominator < 0)
+						{
+							numerator = -numerator;
+							denominator = -denominator;
+						}
+						numerators[v][k] = numerator;
+						denominators[v][k] = denominator;
+						common = common / std::gcd(common, denominator) * denominator;
+					}
+				}
+
+				Finite_Difference_Weights output = {};
+				output.denominator = double(common);
+				for (size_t v = 0; v < width; ++v)
+				{
+					for (size_t k = 0; k < width; ++k)
+					{
+						output.coefficients[v][k] = double(numerators[v][k] * (common / denominators[v][k]));
+					}
+				}
+				return output;
+			}
+		};
+
+		//coefficient table for a one dimensional finite difference stencil of the derivative'th
+		//derivative (1 or 2), accurate to order (2, 4, 6 or 8) in the interior.
+		//every variant reads width consecutive points starting at offset -variant
+		//from the point being evaluated. variant radius is the central stencil,
+		//variant v < radius is used v points from the start of an axis and
+		//variant v > radius is used 2 * radius - v points from the end.
+		//results are scaled by 1 / (denominator * spacing^derivative). the one sided variants
+		//have the same width, which keeps first derivatives at order but second derivatives
+		//lose one order at the boundaries.
+		template<size_t derivative, size_t order>
+		struct FiniteDifferenceStencil
+		{
+			static_assert(derivative == 1 || derivative == 2, "Only first and second derivative stencils are available.");
+			static_assert(order >= 2 && order <= 8 && order % 2 == 0, "Stencil order must be 2, 4, 6 or 8.");
+
+			static constexpr size_t radius = order / 2;
+			static constexpr size_t width = 2 * radius + 1;
+			static constexpr size_t variants = 2 * radius + 1;
+
+			static constexpr Finite_Difference_Weights<derivative, width> weights =
+				Finite_Difference_Weights<derivative, width>::build();
+			static constexpr double denominator = weights.denominator;
+			static constexpr std::array<std::array<double, width>, variants> coefficients = weights.coefficients;
+
+			static constexpr double spacingPower(double spacing)
+			{
+				return derivative == 2 ? spacing * spacing : spacing;
+			}
+		};
+
+		//the default gradient stencil ({1, -8, 0, 8, -1} / 12 in the interior)
+		typedef FiniteDifferenceStencil<1, 4> FourthOrderFirstDerivative;
+
+		//fixed grids check this with a static_assert, run time grids when a stencil is applied
+		template<typename Stencil>
+		void checkStencilExtents(const size_t* extents, size_t dimensions)
+		{
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				if (extents[axis] < Stencil::width)
+				{
+					throw std::invalid_argument("Every axis needs at least order + 1 points for this stencil.");
+				}
+			}
+		}
+
+		//which derivatives (along axis, of stored component c) a stencil engine computes, all of them unless
+		//an operator that reads only some of them says otherwise
+		struct All_Derivatives
+		{
+			static constexpr bool used(size_t, size_t)
+			{
+				return true;
+			}
+		};
+
+		//applies a stencil along every axis of a row-major grid in one pass, so that
+		//an input with components values per point produces dimensions * components
+		//values per point (the derivative direction is the slowest varying).
+		//Layout (PointMajor or ComponentMajor) is the storage order of input and output.
+		//the grid is cut into tiles (multi-index order) made of rows along the last axis, and the
+		//tiles are shared out over the parallel execution threads. which stencil variant (or periodic
+		//wrap) each axis needs is decided once per row. rows that are central along every axis
+		//(all but the outer radius layers) run a loop with the weights and the neighbour steps as
+		//constants: the zero centre weight drops out, the last axis step is known at compile time and
+		//every point is the previous one moved by pointStride, so the loop over the points vectorizes.
+		//with ghosts (at least radius) the outer ghosts points of every axis are ghost cells:
+		//only the points inside them are computed, all with the central stencil.
+		template<size_t dimensions, size_t components, typename T, typename Stencil, bool periodic,
+			typename Layout = PointMajor, typename Derivatives = All_Derivatives>
+		class GradientStencilEngine
+		{
+			static constexpr size_t lastAxis = dimensions - 1;
+			static constexpr size_t inputPointStride = Layout::pointStride(components);
+			static constexpr size_t width = Stencil::width;
+			static constexpr size_t radius = Stencil::radius;
+
+			//number of grid points aimed for in one tile
+			static constexpr size_t tilePoints = 4096;
+			static constexpr size_t rowTile = 256;
+
+			size_t extents[dimensions];
+			size_t strides[dimensions];
+			size_t tileExtents[dimensions];
+			size_t componentStride;
+			size_t ghosts;
+			T weights[Stencil::variants][width];
+			T scales[dimensions];
+
+			//offsets (in scalars, from component 0) of the neighbours used for each axis and the weights they get
+			struct RowState
+			{
+				std::ptrdiff_t offsets[dimensions][width];
+				const T* rowWeights[dimensions];
+			};
+
+			inline size_t variant(size_t position, size_t axis) const
+			{
+				if (periodic || (position >= radius && position < extents[axis] - radius))
+				{
+					return radius;
+				}
+				return position < radius ? position : 2 * radius - (extents[axis] - 1 - position);
+			}
+
+			//prepares the stencil along axis for a point at position, where base is the
+			//flat point index the later point index is added to
+			inline void setAxis(RowState& state, size_t axis, size_t position, std::ptrdiff_t base) const
+			{
+				size_t v = variant(position, axis);
+				state.rowWeights[axis] = weights[v];
+				for (size_t k = 0; k < width; ++k)
+				{
+					std::ptrdiff_t neighbour;
+					if constexpr (periodic)
+					{
+						neighbour = (std::ptrdiff_t)((position + extents[axis] + k - radius) % extents[axis])
+							- (std::ptrdiff_t)position;
+					}
+					else
+					{
+						neighbour = (std::ptrdiff_t)k - (std::ptrdiff_t)v;
+					}
+					state.offsets[axis][k] = (base + neighbour * (std::ptrdiff_t)strides[axis]) * (std::ptrdiff_t)inputPointStride;
+				}
+			}
+
+			//central stencil term k around input, neighbours step scalars apart. the weights
+			//are constants, so the zero ones drop out
+			template<size_t k>
+			static inline void addCentral(T& sum, const T* input, std::ptrdiff_t step)
+			{
+				constexpr double weight = Stencil::coefficients[radius][k];
+				if constexpr (weight != 0)
+				{
+					sum += T(weight) * input[((std::ptrdiff_t)k - (std::ptrdiff_t)radius) * step];
+				}
+			}
+
+			template<size_t... ks>
+			static inline T centralSum(const T* input, std::ptrdiff_t step, std::index_sequence<ks...>)
+			{
+				T sum = T();
+				(addCentral<ks>(sum, input, step), ...);
+				return sum;
+			}
+
+			//neighbour steps (in scalars) and scales of every axis for a central row.
+			//the kernels take it by value, so the compiler knows the output stores cannot change it.
+			struct CentralRow
+			{
+				std::ptrdiff_t steps[dimensions];
+				T scales[dimensions];
+			};
+
+			//the hot loops, for rows that are central along every axis (all but the outer radius layers).
+			//input and output are at the row start, [begin, end) are the points computed.
+			//the loop over the points is innermost and unit stride, the last axis steps by one.
+			static void centralComponentMajor(const T* input, T* output, size_t componentStride, size_t outputComponentStride,
+				CentralRow row, size_t begin, size_t end)
+			{
+				constexpr std::make_index_sequence<width> ks;
+				for (size_t c = 0; c < components; ++c)
+				{
+					const T* inputComponent = input + c * componentStride;
+					for (size_t axis = 0; axis < dimensions; ++axis)
+					{
+						if (!Derivatives::used(axis, c))
+						{
+							continue;
+						}
+						T* outputComponent = output + (axis * components + c) * outputComponentStride;
+						std::ptrdiff_t step = axis == lastAxis ? 1 : row.steps[axis];
+						T scale = row.scales[axis];
+						for (size_t x = begin; x < end; ++x)
+						{
+							outputComponent[x] = centralSum(inputComponent + x, step, ks) * scale;
+						}
+					}
+				}
+			}
+
+			//the axes are unrolled at compile time and the component loop has a constant trip count,
+			//which leaves the loop over the points innermost, moving the input by components and the
+			//output by components * dimensions. the last axis neighbours are a constant components scalars apart.
+			template<size_t axis>
+			static inline void centralAxis(const T* inputPoint, T* outputPoint, std::ptrdiff_t step, T scale)
+			{
+				constexpr std::make_index_sequence<width> ks;
+				for (size_t c = 0; c < components; ++c)
+				{
+					if (Derivatives::used(axis, c))
+					{
+						outputPoint[axis * components + c] = centralSum(inputPoint + c, step, ks) * scale;
+					}
+				}
+			}
+
+			template<size_t... axes>
+			static void centralPointMajor(const T* input, T* output, CentralRow row, size_t begin, size_t end,
+				std::index_sequence<axes...>)
+			{
+				for (size_t x = begin; x < end; ++x)
+				{
+					(centralAxis<axes>(input + x * components, output + x * components * dimensions,
+						axes == lastAxis ? (std::ptrdiff_t)components : row.steps[axes], row.scales[axes]), ...);
+				}
+			}
+
+			//rows near a boundary (or periodic wrap) of the other axes, and the boundary points of every row.
+			//every trip count is a compile time constant apart from the row segment.
+			//output point x of the row is outputRowStart + x, with outputComponentStride between components.
+			inline void applySegment(const RowState& state, const T* input, T* output,
+				size_t outputRowStart, size_t outputComponentStride, size_t begin, size_t end) const
+			{
+				if constexpr (Layout::componentMajor)
+				{
+					for (size_t c = 0; c < components; ++c)
+					{
+						const T* inputComponent = input + c * componentStride;
+						for (size_t axis = 0; axis < dimensions; ++axis)
+						{
+							if (!Derivatives::used(axis, c))
+							{
+								continue;
+							}
+							const T* axisWeights = state.rowWeights[axis];
+							const std::ptrdiff_t* axisOffsets = state.offsets[axis];
+							T* outputComponent = output + (axis * components + c) * outputComponentStride + outputRowStart;
+							for (size_t x = begin; x < end; ++x)
+							{
+								T sum = T();
+								for (size_t k = 0; k < width; ++k)
+								{
+									sum += axisWeights[k] * inputComponent[axisOffsets[k] + x];
+								}
+								outputComponent[x] = sum * scales[axis];
+							}
+						}
+					}
+				}
+				else
+				{
+					for (size_t x = begin; x < end; ++x)
+					{
+						T* outputPoint = output + (outputRowStart + x) * components * dimensions;
+						for (size_t c = 0; c < components; ++c)
+						{
+							for (size_t axis = 0; axis < dimensions; ++axis)
+							{
+								if (!Derivatives::used(axis, c))
+								{
+									continue;
+								}
+								const T* axisWeights = state.rowWeights[axis];
+								T sum = T();
+								for (size_t k = 0; k < width; ++k)
+								{
+									sum += axisWeights[k] * input[state.offsets[axis][k] + x * components + c];
+								}
+								outputPoint[axis * components + c] = sum * scales[axis];
+							}
+						}
+					}
+				}
+			}
+
+			//first point of the row through position
+			inline size_t rowStart(const size_t* position) const
+			{
+				size_t output = 0;
+				for (size_t axis = 0; axis < lastAxis; ++axis)
+				{
+					output += position[axis] * strides[axis];
+				}
+				return output;
+			}
+
+			//points [begin, end) of the row starting at point rowStart, written as in applySegment
+			void applyRow(const size_t* position, size_t rowStart, const T* input, T* output,
+				size_t outputRowStart, size_t outputComponentStride, size_t begin, size_t end) const
+			{
+				RowState state;
+				for (size_t axis = 0; axis < lastAxis; ++axis)
+				{
+					setAxis(state, axis, position[axis], rowStart);
+				}
+
+				size_t rowLength = extents[lastAxis];
+				size_t interiorBegin = std::min(std::max(begin, radius), end);
+				size_t interiorEnd = std::max(std::min(end, rowLength - radius), interiorBegin);
+
+				//boundary points along the row each get their own stencil
+				for (size_t x = begin; x < interiorBegin; ++x)
+				{
+					setAxis(state, lastAxis, x, (std::ptrdiff_t)rowStart);
+					applySegment(state, input, output, outputRowStart, outputComponentStride, x, x + 1);
+				}
+
+				bool central = true;
+				for (size_t axis = 0; axis < lastAxis; ++axis)
+				{
+					central = central && position[axis] >= radius && position[axis] < extents[axis] - radius;
+				}
+				if (central)
+				{
+					CentralRow row;
+					for (size_t axis = 0; axis < dimensions; ++axis)
+					{
+						row.steps[axis] = (std::ptrdiff_t)(strides[axis] * inputPointStride);
+						row.scales[axis] = scales[axis];
+					}
+					if constexpr (Layout::componentMajor)
+					{
+						centralComponentMajor(input + rowStart, output + outputRowStart, componentStride, outputComponentStride,
+							row, interiorBegin, interiorEnd);
+					}
+					else
+					{
+						centralPointMajor(input + rowStart * components, output + outputRowStart * components * dimensions,
+							row, interiorBegin, interiorEnd, std::make_index_sequence<dimensions>());
+					}
+				}
+				else
+				{
+					setAxis(state, lastAxis, radius, (std::ptrdiff_t)rowStart);
+					applySegment(state, input, output, outputRowStart, outputComponentStride, interiorBegin, interiorEnd);
+				}
+
+				for (size_t x = interiorEnd; x < end; ++x)
+				{
+					setAxis(state, lastAxis, x, (std::ptrdiff_t)rowStart);
+					applySegment(state, input, output, outputRowStart, outputComponentStride, x, x + 1);
+				}
+			}
+
+			//advances position through the box [begin, end) in multi-index order over the
+			//first count axes, returns false once every position has been visited
+			static inline bool nextPosition(size_t* position, const size_t* begin, const size_t* end, size_t count)
+			{
+				for (size_t axis = count; axis > 0; --axis)
+				{
+					if (++position[axis - 1] < end[axis - 1])
+					{
+						return true;
+					}
+					position[axis - 1] = begin[axis - 1];
+				}
+				return false;
+			}
+
+			//calls row(position, begin, end) for the rows of the tiles [firstTile, endTile),
+			//numbered in multi-index order over tileCounts
+			template<typename Row>
+			void applyTiles(const size_t* tileCounts, size_t firstTile, size_t endTile, const Row& row) const
+			{
+				for (size_t tile = firstTile; tile < endTile; ++tile)
+				{
+					size_t tileBegin[dimensions];
+					size_t tileEnd[dimensions];
+					for (size_t axis = dimensions, rest = tile; axis > 0; --axis)
+					{
+						size_t tilePosition = rest % tileCounts[axis - 1];
+						rest /= tileCounts[axis - 1];
+						tileBegin[axis - 1] = ghosts + tilePosition * tileExtents[axis - 1];
+						tileEnd[axis - 1] = std::min(tileBegin[axis - 1] + tileExtents[axis - 1], extents[axis - 1] - ghosts);
+					}
+
+					size_t position[dimensions];
+					std::copy(tileBegin, tileBegin + dimensions, position);
+					do
+					{
+						row(position, tileBegin[lastAxis], tileEnd[lastAxis]);
+					}
+					while (nextPosition(position, tileBegin, tileEnd, lastAxis));
+				}
+			}
+
+		public:
+			//spacing is the distance between grid points along each axis
+			GradientStencilEngine(const size_t* initExtents, const double* spacing, size_t initGhosts = 0)
+			:
+				ghosts(initGhosts)
+			{
+				checkStencilExtents<Stencil>(initExtents, dimensions);
+				for (size_t axis = 0; axis < dimensions; ++axis)
+				{
+					scales[axis] = T(1 / (Stencil::denominator * Stencil::spacingPower(spacing[axis])));
+				}
+
+				size_t stride = 1;
+				for (size_t axis = dimensions; axis > 0; --axis)
+				{
+					extents[axis - 1] = initExtents[axis - 1];
+					strides[axis - 1] = stride;
+					stride *= extents[axis - 1];
+				}
+				componentStride = Layout::componentStride(stride);
+
+				size_t remaining = tilePoints;
+				for (size_t axis = dimensions; axis > 0; --axis)
+				{
+					size_t limit = axis - 1 == lastAxis ? rowTile : remaining;
+					tileExtents[axis - 1] = std::max<size_t>(1, std::min(extents[axis - 1], limit));
+					remaining = std::max<size_t>(1, remaining / tileExtents[axis - 1]);
+				}
+
+				for (size_t v = 0; v < Stencil::variants; ++v)
+				{
+					for (size_t k = 0; k < width; ++k)
+					{
+						weights[v][k] = T(Stencil::coefficients[v][k]);
+					}
+				}
+			}
+
+			//runs body(tileCounts, firstTile, endTile) over every tile on the parallel execution threads
+			template<typename Body>
+			void forTiles(const Body& body) const
+			{
+				size_t tileCounts[dimensions];
+				size_t tiles = 1;
+				for (size_t axis = 0; axis < dimensions; ++axis)
+				{
+					tileCounts[axis] = (extents[axis] - 2 * ghosts + tileExtents[axis] - 1) / tileExtents[axis];
+					tiles *= tileCounts[axis];
+				}
+				parallelFor(tiles, [&](size_t firstTile, size_t endTile)
+				{
+					body((const size_t*)tileCounts, firstTile, endTile);
+				});
+			}
+
+			void apply(const T* input, T* output) const
+			{
+				forTiles([&](const size_t* tileCounts, size_t firstTile, size_t endTile)
+				{
+					applyTiles(tileCounts, firstTile, endTile, [&](const size_t* position, size_t begin, size_t end)
+					{
+						size_t start = rowStart(position);
+						applyRow(position, start, input, output, start, componentStride, begin, end);
+					});
+				});
+			}
+
+			//the derivatives are not stored: each row segment goes to a buffer and then to
+			//combine(firstPoint, count, derivatives, derivativeComponentStride), which turns them into
+			//whatever the caller needs. derivatives holds the count points from firstPoint laid out like
+			//the output of apply, with derivativeComponentStride between components (only the ones
+			//Derivatives uses are set).
+			template<typename Combine>
+			void applyCombined(const T* input, const Combine& combine) const
+			{
+				size_t rowLength = extents[lastAxis];
+				forTiles([&](const size_t* tileCounts, size_t firstTile, size_t endTile)
+				{
+					//pooled, so steady state stepping reuses the scratch instead of going to the heap
+					std::shared_ptr<T[]> buffer = pooledArray<T>(rowLength * components * dimensions, false);
+					applyTiles(tileCounts, firstTile, endTile, [&](const size_t* position, size_t begin, size_t end)
+					{
+						size_t start = rowStart(position);
+						applyRow(position, start, input, buffer.get(), 0, rowLength, begin, end);
+						combine(start + begin, end - begin, (const T*)buffer.get() + begin * Layout::pointStride(components * dimensions),
+							Layout::componentStride(rowLength));
+					});
+				});
+			}
+		};
+
+		//applies a stencil along every axis of a tiled or Morton ordered grid, laid out like the output of
+		//GradientStencilEngine. both orders keep aligned cubes of blockSide() points per axis contiguous
+		//(the tiles, or Z order blocks) and their point index is a sum of one term per axis, so the
+		//blocks are shared out over the threads and the neighbour offsets of a block come from per axis
+		//tables of those terms, set up once per block, instead of mapping every neighbour through the grid.
+		template<typename Grid, size_t components, typename T, typename Stencil, bool periodic,
+			typename Layout = PointMajor, typename Derivatives = All_Derivatives>
+		class OrderedGradientStencilEngine
+		{
+			static_assert(!Grid::rowMajor, "Row major grids use GradientStencilEngine.");
+
+			static constexpr size_t dimensions = Grid::dimensions;
+			static constexpr size_t width = Stencil::width;
+			static constexpr size_t radius = Stencil::radius;
+			static constexpr size_t inputPointStride = Layout::pointStride(components);
+			static constexpr size_t outputPointStride = Layout::pointStride(components * dimensions);
+			static constexpr size_t componentStride = Layout::componentStride(Grid::points);
+
+			//Morton grids use the largest aligned cube of at most blockTarget points
+			static constexpr size_t blockTarget = 4096;
+
+			static constexpr size_t cubePoints(size_t side)
+			{
+				size_t output = 1;
+				for (size_t axis = 0; axis < dimensions; ++axis)
+				{
+					output *= side;
+				}
+				return output;
+			}
+
+			static constexpr size_t blockSide()
+			{
+				if (Grid::tile != 0)
+				{
+					return Grid::tile;
+				}
+				size_t output = 1;
+				while (output * 2 <= Grid::extents[0] && cubePoints(output * 2) <= blockTarget)
+				{
+					output *= 2;
+				}
+				return output;
+			}
+
+			static constexpr size_t side = blockSide();
+			static constexpr size_t blockPoints = cubePoints(side);
+
+			//neighbour offsets (in points) and stencil variant for each coordinate of a block along one axis
+			struct BlockAxis
+			{
+				std::ptrdiff_t offsets[side][width];
+				size_t variants[side];
+			};
+
+			Grid grid;
+			T weights[Stencil::variants][width];
+			T scales[dimensions];
+			//axisTerms[axis][x] is the part of a point index that comes from coordinate x along axis
+			std::vector<size_t> axisTerms[dimensions];
+
+			void setBlockAxis(BlockAxis& blockAxis, size_t axis, size_t origin) const
+			{
+				const size_t extent = Grid::extents[axis];
+				for (size_t x = 0; x < side; ++x)
+				{
+					size_t position = origin + x;
+					size_t v = radius;
+					if (!periodic && (position < radius || position >= extent - radius))
+					{
+						v = position < radius ? position : 2 * radius - (extent - 1 - position);
+					}
+					blockAxis.variants[x] = v;
+					for (size_t k = 0; k < width; ++k)
+					{
+						size_t target = periodic ? (position + extent + k - radius) % extent : position + k - v;
+						blockAxis.offsets[x][k] = (std::ptrdiff_t)axisTerms[axis][target] - (std::ptrdiff_t)axisTerms[axis][position];
+					}
+				}
+			}
+
+			template<size_t k>
+			static inline void addCentral(T& sum, const T* source, const std::ptrdiff_t* offsets)
+			{
+				constexpr double weight = Stencil::coefficients[radius][k];
+				if constexpr (weight != 0)
+				{
+					sum += T(weight) * source[offsets[k] * (std::ptrdiff_t)inputPointStride];
+				}
+			}
+
+			//central stencil with its weights as constants, so the zero ones drop out
+			template<size_t... ks>
+			static inline T centralSum(const T* source, const std::ptrdiff_t* offsets, std::index_sequence<ks...>)
+			{
+				T sum = T();
+				(addCentral<ks>(sum, source, offsets), ...);
+				return sum;
+			}
+
+			//output is at the start of the block, with outputComponentStride between components
+			inline void applyPoint(const BlockAxis* blockAxes, const size_t* local, size_t point, size_t blockPoint,
+				const T* input, T* output, size_t outputComponentStride) const
+			{
+				for (size_t axis = 0; axis < dimensions; ++axis)
+				{
+					const std::ptrdiff_t* offsets = blockAxes[axis].offsets[local[axis]];
+					size_t v = blockAxes[axis].variants[local[axis]];
+					for (size_t c = 0; c < components; ++c)
+					{
+						if (!Derivatives::used(axis, c))
+						{
+							continue;
+						}
+						const T* source = input + point * inputPointStride + c * componentStride;
+						T sum = T();
+						if (v == radius)
+						{
+							sum = centralSum(source, offsets, std::make_index_sequence<width>());
+						}
+						else
+						{
+							for (size_t k = 0; k < width; ++k)
+							{
+								sum += weights[v][k] * source[offsets[k] * (std::ptrdiff_t)inputPointStride];
+							}
+						}
+						output[blockPoint * outputPointStride + (axis * components + c) * outputComponentStride] = sum * scales[axis];
+					}
+				}
+			}
+
+			//the block's rows along the last axis in turn. the block is aligned, so the terms of
+			//its coordinates add to its start. output is written as in applyPoint
+			void applyBlock(size_t block, const T* input, T* output, size_t outputComponentStride) const
+			{
+				size_t blockStart = block * blockPoints;
+				BlockAxis blockAxes[dimensions];
+				for (size_t axis = 0; axis < dimensions; ++axis)
+				{
+					setBlockAxis(blockAxes[axis], axis, grid.coordinate(blockStart, axis));
+				}
+
+				for (size_t row = 0; row < blockPoints / side; ++row)
+				{
+					size_t local[dimensions];
+					size_t rowStart = 0;
+					for (size_t axis = dimensions - 1, rest = row; axis > 0; --axis, rest /= side)
+					{
+						local[axis - 1] = rest % side;
+						rowStart += axisTerms[axis - 1][local[axis - 1]];
+					}
+					for (size_t x = 0; x < side; ++x)
+					{
+						local[dimensions - 1] = x;
+						size_t blockPoint = rowStart + axisTerms[dimensions - 1][x];
+						applyPoint(blockAxes, local, blockStart + blockPoint, blockPoint, input, output, outputComponentStride);
+					}
+				}
+			}
+		public:
+			//spacing is the distance between grid points along each axis
+			OrderedGradientStencilEngine(const Grid& initGrid, const double* spacing)
+			:
+				grid(initGrid)
+			{
+				checkStencilExtents<Stencil>(Grid::extents, dimensions);
+				for (size_t axis = 0; axis < dimensions; ++axis)
+				{
+					scales[axis] = T(1 / (Stencil::denominator * Stencil::spacingPower(spacing[axis])));
+					axisTerms[axis].resize(Grid::extents[axis]);
+					std::array<size_t, dimensions> position = {};
+					for (size_t x = 0; x < Grid::extents[axis]; ++x)
+					{
+						position[axis] = x;
+						axisTerms[axis][x] = grid.index(position);
+					}
+				}
+				for (size_t v = 0; v < Stencil::variants; ++v)
+				{
+					for (size_t k = 0; k < width; ++k)
+					{
+						weights[v][k] = T(Stencil::coefficients[v][k]);
+					}
+				}
+			}
+
+			void apply(const T* input, T* output) const
+			{
+				parallelFor(Grid::points / blockPoints, [&](size_t firstBlock, size_t endBlock)
+				{
+					for (size_t block = firstBlock; block < endBlock; ++block)
+					{
+						applyBlock(block, input, output + block * blockPoints * outputPointStride, componentStride);
+					}
+				});
+			}
+
+			//GradientStencilEngine::applyCombined, one block of points at a time
+			template<typename Combine>
+			void applyCombined(const T* input, const Combine& combine) const
+			{
+				parallelFor(Grid::points / blockPoints, [&](size_t firstBlock, size_t endBlock)
+				{
+					std::shared_ptr<T[]> buffer = pooledArray<T>(blockPoints * components * dimensions, false);
+					for (size_t block = firstBlock; block < endBlock; ++block)
+					{
+						applyBlock(block, input, buffer.get(), Layout::componentStride(blockPoints));
+						combine(block * blockPoints, blockPoints, (const T*)buffer.get(), Layout::componentStride(blockPoints));
+					}
+				});
+			}
+		};
+	}
+
+}
@@ -0,0 +1,96 @@
+namespace SimulationUtilities{
+
+	namespace
+	{
+		//the known version of Expression: a tensor whose every element is known at compile time
+		//(Symbol::value of the bound index values), so it holds no data. products with it skip
+		//the terms it makes zero and multiply by its +-1 at compile time, e.g. a contraction
+		//with a Kronecker delta becomes a substitution of the index.
+		template<size_t dimensions, typename T, typename Symbol,
+			typename... FreeIndices, typename... Is, typename... RepeatIs>
+		struct Expression<'k', dimensions, T, IndexPackType<FreeIndices...>,
+			Symbol, IndexPackType<Is...>, IndexPackType<RepeatIs...>>
+		{
+			struct Terms
+			{
+				template<typename Bound>
+				static constexpr Known_Term info()
+				{
+					return {true, Symbol::value({Template_Bound_Value<Is, Bound>::value...})};
+				}
+			};
+
+			template<typename Binding>
+			static constexpr Known_Term known()
+			{
+				return Sum_Over_Known<dimensions, T, Binding, Terms, RepeatIs...>::info;
+			}
+
+			//generic expression requirements
+
+			template<typename Binding>
+			inline T getValue() const
+			{
+				return T(known<Binding>().value);
+			}
+		};
+
+		template<size_t dimensions, typename T, typename Symbol, typename... IndexIdentifiers>
+		using Known_Expression = Expression<'k', dimensions, T,
+			typename Template_Remove_Repeats<IndexIdentifiers...>::T,
+			Symbol, IndexPackType<IndexIdentifiers...>,
+			typename Template_Get_Repeats<IndexIdentifiers...>::T>;
+	}
+
+	//delta(i, j) is 1 where i and j take the same value, 0 elsewhere. it holds no data,
+	//A(i, j) * delta(j, k) is evaluated as A(i, k) and delta(i, i) as dimensions.
+	template<size_t dimensions, typename T = double>
+	struct KroneckerDelta
+	{
+		static constexpr int value(const std::array<size_t, 2>& values)
+		{
+			return values[0] == values[1] ? 1 : 0;
+		}
+
+		template<typename I1, typename I2>
+		auto operator()(I1, I2) const
+		{
+			return Known_Expression<dimensions, T, KroneckerDelta<dimensions, T>, I1, I2>();
+		}
+	};
+
+	//epsilon(i, j, k, ...) (dimensions indices) is the sign of the permutation i, j, k, ... of 0, 1, 2, ...
+	//and 0 if any two are equal. it holds no data, a contraction with it only adds the non zero terms,
+	//e.g. epsilon(i, j, k) * u(j) * v(k) is the 6 products of the cross product.
+	template<size_t dimensions, typename T = double>
+	struct LeviCivita
+	{
+		static constexpr int value(const std::array<size_t, dimensions>& values)
+		{
+			int sign = 1;
+			for (size_t i = 0; i < dimensions; ++i)
+			{
+				for (size_t j = i + 1; j < dimensions; ++j)
+				{
+					if (values[i] == values[j])
+					{
+						return 0;
+					}
+					if (values[i] > values[j])
+					{
+						sign = -sign;
+					}
+				}
+			}
+			return sign;
+		}
+
+		template<typename... IndexIdentifiers>
+		auto operator()(IndexIdentifiers...) const
+		{
+			static_assert(sizeof...(IndexIdentifiers) == dimensions, "the Levi-Civita symbol takes one index per dimension.");
+			return Known_Expression<dimensions, T, LeviCivita<dimensions, T>, IndexIdentifiers...>();
+		}
+	};
+
+}
@@ -0,0 +1,568 @@
+namespace SimulationUtilities{
+
+	//index symmetries a tensor's storage can use. with Symmetric<leading> (Antisymmetric<leading>)
+	//the tensor is unchanged (changes sign) when any two of its indices after the first leading
+	//are exchanged, so only one element of every such group is stored.
+	//the gradient of a Symmetric<leading> field is Symmetric<leading + 1> (the derivative index comes first).
+
+	struct NoSymmetry{};
+
+	template<size_t leading = 0>
+	struct Symmetric
+	{
+		static constexpr size_t leadingIndices = leading;
+		static constexpr bool antisymmetric = false;
+	};
+
+	template<size_t leading = 0>
+	struct Antisymmetric
+	{
+		static constexpr size_t leadingIndices = leading;
+		static constexpr bool antisymmetric = true;
+	};
+
+	template<size_t dimensions, size_t rank, typename Symmetry, typename T = double>
+	class PackedTensor;
+
+	template<size_t dimensions, size_t rank, typename T = double>
+	using SymmetricTensor = PackedTensor<dimensions, rank, Symmetric<>, T>;
+
+	template<size_t dimensions, size_t rank, typename T = double>
+	using AntisymmetricTensor = PackedTensor<dimensions, rank, Antisymmetric<>, T>;
+
+	namespace
+	{
+		//where every element of a dimensions^rank tensor (row major flat position) is stored when the
+		//indices from leading on are (anti)symmetric. stored elements are the ones whose symmetric
+		//indices are in increasing order (strictly increasing when antisymmetric), kept in row major order,
+		//so the leading indices stay the slowest varying. built at compile time.
+		template<size_t dimensions, size_t rank, size_t leading, bool antisymmetric>
+		struct Packed_Table
+		{
+			static_assert(leading <= rank, "More leading indices than the rank.");
+			static constexpr size_t elements = Template_Power<dimensions, rank>::value;
+
+			struct Data
+			{
+				size_t size;//number of stored elements
+				size_t position[elements];//stored element used by each element
+				int sign[elements];//+1, -1, or 0 for elements that are always zero
+				size_t canonical[elements];//element each stored element is (first size entries)
+				size_t multiplicity[elements];//number of non zero elements sharing each stored element
+			};
+
+			static constexpr Data build()
+			{
+				Data data{};
+				size_t sorted[elements]{};
+				for (size_t element = 0; element < elements; ++element)
+				{
+					size_t digits[rank + 1]{};
+					for (size_t position = 0, rest = element; position < rank; ++position)
+					{
+						digits[rank - 1 - position] = rest % dimensions;
+						rest /= dimensions;
+					}
+					//insertion sort of the symmetric indices, counting exchanges for the sign
+					size_t exchanges = 0;
+					bool repeated = false;
+					for (size_t i = leading + 1; i < rank; ++i)
+					{
+						for (size_t j = i; j > leading && digits[j - 1] >= digits[j]; --j)
+						{
+							if (digits[j - 1] == digits[j])
+							{
+								repeated = true;
+								break;
+							}
+							size_t swap = digits[j - 1];
+							digits[j - 1] = digits[j];
+							digits[j] = swap;
+							++exchanges;
+						}
+					}
+					size_t flat = 0;
+					for (size_t position = 0; position < rank; ++position)
+					{
+						flat = flat * dimensions + digits[position];
+					}
+					sorted[element] = flat;
+					data.sign[element] = antisymmetric ? (repeated ? 0 : (exchanges % 2 ? -1 : 1)) : 1;
+				}
+				size_t slot[elements]{};
+				for (size_t element = 0; element < elements; ++element)
+				{
+					if (sorted[element] == element && data.sign[element] != 0)
+					{
+						slot[element] = data.size;
+						data.canonical[data.size++] = element;
+					}
+				}
+				for (size_t element = 0; element < elements; ++element)
+				{
+					if (data.sign[element] != 0)
+					{
+						data.position[element] = slot[sorted[element]];
+						++data.multiplicity[data.position[element]];
+					}
+				}
+				return data;
+			}
+
+			static constexpr Data data = build();
+		};
+
+		//Symmetry_Storage gives the number of stored components and, for every element, the stored
+		//component it comes from (position) and the sign it is read with (0 means always zero)
+
+		template<size_t dimensions, size_t rank, typename Symmetry>
+		struct Symmetry_Storage
+		{
+			typedef Packed_Table<dimensions, rank, Symmetry::leadingIndices, Symmetry::antisymmetric> Table;
+			static constexpr size_t components = Table::data.size;
+			static_assert(components != 0, "An antisymmetric tensor with more antisymmetric indices than dimensions is always zero.");
+			static constexpr size_t position(size_t element){return Table::data.position[element];}
+			static constexpr int sign(size_t element){return Table::data.sign[element];}
+			static constexpr size_t canonical(size_t component){return Table::data.canonical[component];}
+			static constexpr size_t multiplicity(size_t component){return Table::data.multiplicity[component];}
+		};
+
+		template<size_t dimensions, size_t rank>
+		struct Symmetry_Storage<dimensions, rank, NoSymmetry>
+		{
+			static constexpr size_t components = Template_Power<dimensions, rank>::value;
+			static constexpr size_t position(size_t element){return element;}
+			static constexpr int sign(size_t){return 1;}
+			static constexpr size_t canonical(size_t component){return component;}
+			static constexpr size_t multiplicity(size_t){return 1;}
+		};
+
+		//Symmetry_Tensor T is the tensor type stored at each point of a field with that symmetry
+
+		template<size_t dimensions, size_t rank, typename Scalar, typename Symmetry>
+		struct Symmetry_Tensor
+		{
+			typedef PackedTensor<dimensions, rank, Symmetry, Scalar> T;
+		};
+
+		template<size_t dimensions, size_t rank, typename Scalar>
+		struct Symmetry_Tensor<dimensions, rank, Scalar, NoSymmetry>
+		{
+			typedef Tensor<dimensions, rank, Scalar> T;
+		};
+
+		//Gradient_Symmetry T is the symmetry of the gradient (derivative index first) of a field with Symmetry
+
+		template<typename Symmetry>
+		struct Gradient_Symmetry
+		{
+			typedef NoSymmetry T;
+		};
+
+		template<size_t leading>
+		struct Gradient_Symmetry<Symmetric<leading>>
+		{
+			typedef Symmetric<leading + 1> T;
+		};
+
+		template<size_t leading>
+		struct Gradient_Symmetry<Antisymmetric<leading>>
+		{
+			typedef Antisymmetric<leading + 1> T;
+		};
+
+		//Divergence_Symmetry T is the symmetry left among the other indices when the first index of a rank
+		//field with Symmetry is contracted away (NoSymmetry for results below rank 2)
+
+		template<typename Symmetry, size_t rank>
+		struct Divergence_Symmetry
+		{
+			typedef NoSymmetry T;
+		};
+
+		template<size_t leading, size_t rank>
+		struct Divergence_Symmetry<Symmetric<leading>, rank>
+		{
+			typedef std::conditional_t<(rank > 2), Symmetric<(leading > 0 ? leading - 1 : 0)>, NoSymmetry> T;
+		};
+
+		template<size_t leading, size_t rank>
+		struct Divergence_Symmetry<Antisymmetric<leading>, rank>
+		{
+			typedef std::conditional_t<(rank > 2), Antisymmetric<(leading > 0 ? leading - 1 : 0)>, NoSymmetry> T;
+		};
+
+		//indexed packed tensor type, the packed counterpart of IndexedTensor
+
+		template<size_t rank, size_t dimensions, typename T, size_t stride, typename Symmetry, typename... indexIdentifiers>
+		struct IndexedPackedTensor
+		{
+			static_assert(sizeof...(indexIdentifiers)==rank, "Invalid number of indices on tensor.");
+		};
+
+		//row major flat position of the element picked out by Binding
+		template<size_t dimensions, typename Binding, typename... Is, size_t... positions>
+		constexpr size_t boundElement(std::index_sequence<positions...>)
+		{
+			return (0 + ... + (Template_Bound_Value<Is, Binding>::value
+				* Template_Power<dimensions, sizeof...(Is) - 1 - positions>::value));
+		}
+
+		//the packed single version of Expression. reads go through the symmetry table,
+		//assignments only compute the stored elements.
+		template<size_t rank, size_t dimensions, typename T, size_t stride, typename Symmetry,
+			typename... FreeIndices, typename... Is, typename... RepeatIs>
+		struct Expression<'s', dimensions, T, IndexPackType<FreeIndices...>,
+			IndexedPackedTensor<rank, dimensions, T, stride, Symmetry, Is...>, IndexPackType<RepeatIs...>>
+		{
+			typedef Expression<'s', dimensions, T, IndexPackType<FreeIndices...>,
+				IndexedPackedTensor<rank, dimensions, T, stride, Symmetry, Is...>, IndexPackType<RepeatIs...>> SelfType;
+			typedef Symmetry_Storage<dimensions, rank, Symmetry> Storage;
+
+			T* data;
+
+			Expression(T* initData)
+			:
+				data(initData)
+			{}
+
+			Expression(const SelfType& other)
+			:
+				data(other.data)
+			{}
+
+			template<typename Binding>
+			inline T element() const
+			{
+				constexpr size_t flat = boundElement<dimensions, Binding, Is...>(std::index_sequence_for<Is...>());
+				constexpr int sign = Storage::sign(flat);
+				if constexpr (sign == 0)
+				{
+					return T();
+				}
+				else if constexpr (sign < 0)
+				{
+					return -data[Storage::position(flat) * stride];
+				}
+				else
+				{
+					return data[Storage::position(flat) * stride];
+				}
+			}
+
+			//elements an antisymmetry forces to zero are known, e.g. the trace of an antisymmetric tensor is nothing
+			struct Terms
+			{
+				template<typename Bound>
+				static constexpr Known_Term info()
+				{
+					constexpr int sign = Storage::sign(boundElement<dimensions, Bound, Is...>(std::index_sequence_for<Is...>()));
+					return {sign == 0, 0};
+				}
+			};
+
+			template<typename Binding>
+			static constexpr Known_Term known()
+			{
+				return Sum_Over_Known<dimensions, T, Binding, Terms, RepeatIs...>::info;
+			}
+
+			//generic expression requirements
+
+			template<typename Binding>
+			inline T getValue() const
+			{
+				return Sum_Over_Known<dimensions, T, Binding, Terms, RepeatIs...>::sum([this](auto binding)
+				{
+					return element<decltype(binding)>();
+				});
+			}
+
+			//stored component c takes the other side's value at the element c stands for
+
+			template<typename Other, size_t... components>
+			inline void setEqual(const Other& other, std::index_sequence<components...>)
+			{
+				(void(data[components * stride] = other.template getValue<
+					typename Template_Element_Binding<dimensions, Storage::canonical(components), Is...>::T>()), ...);
+			}
+
+			template<typename Other, size_t... components>
+			inline void add(const Other& other, std::index_sequence<components...>)
+			{
+				(void(data[components * stride] += other.template getValue<
+					typename Template_Element_Binding<dimensions, Storage::canonical(components), Is...>::T>()), ...);
+			}
+
+			template<typename Other, size_t... components>
+			inline void subtract(const Other& other, std::index_sequence<components...>)
+			{
+				(void(data[components * stride] -= other.template getValue<
+					typename Template_Element_Binding<dimensions, Storage::canonical(components), Is...>::T>()), ...);
+			}
+
+			template<char ID, typename... OtherIs>
+			SelfType& operator=(Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, OtherIs...>&& other)
+			{
+				static_assert(sizeof...(RepeatIs) == 0);
+				setEqual(other, std::make_index_sequence<Storage::components>());
+				return *this;
+			}
+
+			SelfType& operator=(SelfType&& other)
+			{
+				for (size_t i = 0; i < Storage::components; ++i)
+				{
+					data[i * stride] = other.data[i * stride];
+				}
+				return *this;
+			}
+
+			template<char ID, typename... OtherIs>
+			SelfType& operator+=(Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, OtherIs...>&& other)
+			{
+				static_assert(sizeof...(RepeatIs) == 0);
+				add(other, std::make_index_sequence<Storage::components>());
+				return *this;
+			}
+
+			template<char ID, typename... OtherIs>
+			SelfType& operator-=(Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, OtherIs...>&& other)
+			{
+				static_assert(sizeof...(RepeatIs) == 0);
+				subtract(other, std::make_index_sequence<Storage::components>());
+				return *this;
+			}
+		};
+
+		//sign of the permutation taking the index order Is1... to Is2..., 0 if it moves any of the first leading indices
+		template<typename... Is1, typename... Is2>
+		constexpr int permutationSign(IndexPackType<Is1...>, IndexPackType<Is2...>, size_t leading)
+		{
+			constexpr size_t count = sizeof...(Is2);
+			size_t positions[count + 1] = {Template_Locate_Key_Type<Is2, Is1...>::value...};
+			size_t inversions = 0;
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (i < leading && positions[i] != i)
+				{
+					return 0;
+				}
+				for (size_t j = i + 1; j < count; ++j)
+				{
+					inversions += positions[i] > positions[j];
+				}
+			}
+			return inversions % 2 ? -1 : 1;
+		}
+
+		//full contraction of two packed tensors with the same symmetry, A(i, j) * B(i, j) and the like.
+		//summed over the stored elements only, each weighted by how many elements share it
+		//(when the leading indices line up, otherwise it is summed like any other product).
+		//partial contractions, such as S(i, j) * v(j), sum over the full index range through the table.
+		//sums are carried in Template_Accumulator<T>::T like the Tensor contractions.
+		template<size_t rank, size_t dimensions, typename T, size_t stride1, size_t stride2, typename Symmetry,
+			typename... Is1, typename... Is2, typename... ContractionIndices>
+		struct Expression<'m', dimensions, T, IndexPackType<>,
+			Expression<'s', dimensions, T, IndexPackType<Is1...>,
+				IndexedPackedTensor<rank, dimensions, T, stride1, Symmetry, Is1...>, IndexPackType<>>,
+			Expression<'s', dimensions, T, IndexPackType<Is2...>,
+				IndexedPackedTensor<rank, dimensions, T, stride2, Symmetry, Is2...>, IndexPackType<>>,
+			IndexPackType<ContractionIndices...>, InverseType<false>>
+		{
+			typedef Symmetry_Storage<dimensions, rank, Symmetry> Storage;
+
+			Expression<'s', dimensions, T, IndexPackType<Is1...>,
+				IndexedPackedTensor<rank, dimensions, T, stride1, Symmetry, Is1...>, IndexPackType<>> val1;
+			Expression<'s', dimensions, T, IndexPackType<Is2...>,
+				IndexedPackedTensor<rank, dimensions, T, stride2, Symmetry, Is2...>, IndexPackType<>> val2;
+
+			typedef typename Template_Accumulator<T>::T Sum;
+
+			template<size_t... components>
+			inline Sum sum(std::index_sequence<components...>) const
+			{
+				return (Sum() + ... + (Sum(Storage::multiplicity(components)) * Sum(val1.data[components * stride1])
+					* Sum(val2.data[components * stride2])));
+			}
+
+			//generic expression requirements
+
+			template<typename Binding>
+			inline T getValue() const
+			{
+				constexpr int sign = permutationSign(IndexPackType<Is1...>(), IndexPackType<Is2...>(), Symmetry::leadingIndices);
+				if constexpr (sign == 0)
+				{
+					return Sum_Over<dimensions, T, Binding, ContractionIndices...>::sum([this](auto binding)
+					{
+						typedef decltype(binding) Bound;
+						return Sum(val1.template getValue<Bound>()) * Sum(val2.template getValue<Bound>());
+					});
+				}
+				else
+				{
+					return T(Sum(Symmetry::antisymmetric ? sign : 1) * sum(std::make_index_sequence<Storage::components>()));
+				}
+			}
+		};
+	}
+
+	//tensor storing only the independent elements of a tensor with an index symmetry
+	//(Symmetric<> or Antisymmetric<>, see above). indexes and takes part in expressions like Tensor.
+	template<size_t dimensions, size_t rank, typename Symmetry, typename T>
+	class PackedTensor
+	{
+		typedef PackedTensor<dimensions, rank, Symmetry, T> SelfType;
+		typedef Symmetry_Storage<dimensions, rank, Symmetry> Storage;
+	public:
+		static constexpr size_t components = Storage::components;
+	private:
+		T data[components];
+	public:
+		PackedTensor()
+		{
+			for (size_t i = 0; i < components; ++i)
+			{
+				data[i] = T();
+			}
+		}
+
+		//the packed components in storage order
+		PackedTensor(std::vector<T> inputValues)
+		{
+			std::copy(inputValues.begin(), inputValues.end(), data);
+		}
+		PackedTensor(T* inputValues)
+		{
+			std::copy(inputValues, inputValues + components, data);
+		}
+
+		//keeps the stored elements of input (the rest of input is assumed to have the symmetry)
+		explicit PackedTensor(const Tensor<dimensions, rank, T>& input)
+		{
+			for (size_t i = 0; i < components; ++i)
+			{
+				data[i] = input.getData()[Storage::canonical(i)];
+			}
+		}
+
+		template<typename... IndexIdentifiers>
+		auto operator()(IndexIdentifiers... indices) const//make single Expression
+		{
+			return Expression<'s', dimensions, T,
+				typename Template_Remove_Repeats<IndexIdentifiers...>::T,
+				IndexedPackedTensor<rank, dimensions, T, 1, Symmetry, IndexIdentifiers...>,
+				typename Template_Get_Repeats<IndexIdentifiers...>::T>((T*)data);
+		}
+
+		SelfType& operator*=(double other)
+		{
+			if constexpr (std::is_floating_point<T>::value)
+			{
+				simdApply<SimdMultiply>(data, T(other), components);
+			}
+			else
+			{
+				for (size_t i = 0; i < components; ++i)
+				{
+					data[i] *= other;
+				}
+			}
+			return *this;
+		}
+
+		SelfType& operator/=(double other)
+		{
+			if constexpr (std::is_floating_point<T>::value)
+			{
+				simdApply<SimdDivide>(data, T(other), components);
+			}
+			else
+			{
+				for (size_t i = 0; i < components; ++i)
+				{
+					data[i] /= other;
+				}
+			}
+			return *this;
+		}
+
+		SelfType& operator+=(const SelfType& other)
+		{
+			simdApply<SimdAdd>(data, (const T*)other.data, components);
+			return *this;
+		}
+
+		SelfType& operator-=(const SelfType& other)
+		{
+			simdApply<SimdSubtract>(data, (const T*)other.data, components);
+			return *this;
+		}
+
+		//every element, as a full Tensor
+		Tensor<dimensions, rank, T> toTensor() const
+		{
+			Tensor<dimensions, rank, T> output;
+			for (size_t i = 0; i < Template_Power<dimensions, rank>::value; ++i)
+			{
+				output.getData()[i] = Storage::sign(i) == 0 ? T() : T(Storage::sign(i)) * data[Storage::position(i)];
+			}
+			return output;
+		}
+
+		T* getData()
+		{
+			return data;
+		}
+
+		const T* getData() const
+		{
+			return data;
+		}
+
+		std::vector<T> getDataCopy() const
+		{
+			return std::vector<T>(data, data + components);
+		}
+	};
+
+	template<size_t dimensions, size_t rank, typename Symmetry, typename T>
+	std::ostream& operator<<(std::ostream& os, const PackedTensor<dimensions, rank, Symmetry, T>& thing)
+	{
+		return os << thing.toTensor();
+	}
+
+	template<size_t dimensions, size_t rank, typename Symmetry, typename T>
+	PackedTensor<dimensions, rank, Symmetry, T> operator+(PackedTensor<dimensions, rank, Symmetry, T> left,
+		const PackedTensor<dimensions, rank, Symmetry, T>& right)
+	{
+		return left += right;
+	}
+
+	template<size_t dimensions, size_t rank, typename Symmetry, typename T>
+	PackedTensor<dimensions, rank, Symmetry, T> operator-(PackedTensor<dimensions, rank, Symmetry, T> left,
+		const PackedTensor<dimensions, rank, Symmetry, T>& right)
+	{
+		return left -= right;
+	}
+
+	template<size_t dimensions, size_t rank, typename Symmetry, typename T>
+	PackedTensor<dimensions, rank, Symmetry, T> operator*(PackedTensor<dimensions, rank, Symmetry, T> left, const double& right)
+	{
+		return left *= right;
+	}
+
+	template<size_t dimensions, size_t rank, typename Symmetry, typename T>
+	PackedTensor<dimensions, rank, Symmetry, T> operator*(const double& left, PackedTensor<dimensions, rank, Symmetry, T> right)
+	{
+		return right *= left;
+	}
+
+	template<size_t dimensions, size_t rank, typename Symmetry, typename T>
+	PackedTensor<dimensions, rank, Symmetry, T> operator/(PackedTensor<dimensions, rank, Symmetry, T> left, const double& right)
+	{
+		return left /= right;
+	}
+
+}
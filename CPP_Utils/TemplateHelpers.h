@@ -54,14 +54,64 @@ namespace SimulationUtilities{
 			static constexpr bool value = false;
 		};
 
-		//generic indexed tensor type
+		//generic indexed tensor type. stride is the distance in memory between consecutive components
 
-		template<size_t rank, size_t dimensions, typename T, typename... indexIdentifiers>
+		template<size_t rank, size_t dimensions, typename T, size_t stride, typename... indexIdentifiers>
 		struct IndexedTensor
 		{
 			static_assert(sizeof...(indexIdentifiers)==rank, "Invalid number of indices on tensor.");
 		};
 
+		//compile time values for index type differentiators. IndexBinding holds the value
+		//given to each index in an expression (IndexValue<Index, value>), earlier entries win.
+
+		template<typename Index, size_t value>
+		struct IndexValue{};
+
+		template<typename... IndexValues>
+		struct IndexBinding{};
+
+		//Template_Bound_Value value is the value Key has in Binding (0 if Key is not bound)
+
+		template<typename Key, typename Binding>
+		struct Template_Bound_Value : public std::integral_constant<size_t, 0>{};
+
+		template<typename Key, typename Next, size_t value, typename... Others>
+		struct Template_Bound_Value<Key, IndexBinding<IndexValue<Next, value>, Others...>> :
+			public Template_Bound_Value<Key, IndexBinding<Others...>>{};
+
+		template<typename Key, size_t value, typename... Others>
+		struct Template_Bound_Value<Key, IndexBinding<IndexValue<Key, value>, Others...>> :
+			public std::integral_constant<size_t, value>{};
+
+		//Template_Bind T is Binding with Key given value
+
+		template<typename Binding, typename Key, size_t value>
+		struct Template_Bind;
+
+		template<typename... Values, typename Key, size_t value>
+		struct Template_Bind<IndexBinding<Values...>, Key, value>
+		{
+			typedef IndexBinding<IndexValue<Key, value>, Values...> T;
+		};
+
+		//Template_Element_Binding T binds Is... to the multi-index of flat position element
+		//in a row major tensor with sizeof...(Is) indices
+
+		template<size_t dimensions, size_t element, typename Positions, typename... Is>
+		struct Template_Element_Binding_Helper;
+
+		template<size_t dimensions, size_t element, size_t... positions, typename... Is>
+		struct Template_Element_Binding_Helper<dimensions, element, std::index_sequence<positions...>, Is...>
+		{
+			typedef IndexBinding<IndexValue<Is,
+				element / Template_Power<dimensions, sizeof...(Is) - 1 - positions>::value % dimensions>...> T;
+		};
+
+		template<size_t dimensions, size_t element, typename... Is>
+		struct Template_Element_Binding :
+			public Template_Element_Binding_Helper<dimensions, element, std::index_sequence_for<Is...>, Is...>{};
+
 		//type to store a group of index type differentiators
 
 		template<typename... Is>
@@ -169,6 +219,24 @@ namespace SimulationUtilities{
 		{
 			static constexpr bool value = true;
 		};
+
+		//T is Type. a parameter of type Template_Identity<T>::T does not take part in deduction,
+		//so a double scalar converts to the T of a float tensor or field instead of failing to deduce
+
+		template<typename Type>
+		struct Template_Identity{typedef Type T;};
+
+		//T is the type sums of Scalar values (contractions, dot products, reductions) are accumulated in.
+		//with SIMULATION_UTILITIES_MIXED_PRECISION defined, float data is summed in double
+		//and rounded once at the end, so fields can be stored in float at half the memory traffic.
+
+		template<typename Scalar>
+		struct Template_Accumulator{typedef Scalar T;};
+
+	#if defined(SIMULATION_UTILITIES_MIXED_PRECISION)
+		template<>
+		struct Template_Accumulator<float>{typedef double T;};
+	#endif
 	}
 
 }
\ No newline at end of file
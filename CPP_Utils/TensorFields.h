@@ -1,91 +1,331 @@
 
 namespace SimulationUtilities{
 
-	template<size_t dimensions, size_t rank, size_t divisions, typename T = double,
-		typename = std::enable_if_t<dimensions != 0 && std::greater<size_t>()(divisions, 4)>>
-	class TensorField;
+	template<typename Grid, size_t rank, typename T = double, typename Layout = PointMajor, typename Symmetry = NoSymmetry>
+	class GridTensorField;
+
+	//tensor field on a grid with divisions points along every axis
+	template<size_t dimensions, size_t rank, size_t divisions, typename T = double, typename Layout = PointMajor,
+		typename Symmetry = NoSymmetry>
+	using TensorField = GridTensorField<typename Uniform_Extents<dimensions, divisions>::T, rank, T, Layout, Symmetry>;
 
 	template<size_t dimensions, size_t divisions>
 	using ScalarField = TensorField<dimensions, 0, divisions>;
 
+	//tensor field whose extents are given to the constructor at run time
+	template<size_t dimensions, size_t rank, typename T = double, typename Symmetry = NoSymmetry>
+	using DynamicTensorField = GridTensorField<DynamicExtents<dimensions>, rank, T, PointMajor, Symmetry>;
+
+	template<typename Grid, size_t rank, typename T, typename Layout, typename Stencil, bool periodic, typename Symmetry = NoSymmetry>
+	class LazyGradient;
+
 	namespace
 	{
-		template<char ID, size_t dimensions, size_t divisions, typename T, typename... Is>
+		template<char ID, size_t dimensions, typename Grid, typename T, typename... Is>
 		struct TensorFieldExpression;
 
+		//rank, symmetry, scalars per point and indexed type of the tensor type stored at each point of a field
+
+		template<typename TensorType>
+		struct Field_Tensor;
+
+		template<size_t dimensions, size_t tensorRank, typename T>
+		struct Field_Tensor<Tensor<dimensions, tensorRank, T>>
+		{
+			static constexpr size_t rank = tensorRank;
+			typedef NoSymmetry Symmetry;
+			static constexpr size_t components = Template_Power<dimensions, rank>::value;
+			template<size_t stride, typename... Is>
+			using Indexed = IndexedTensor<rank, dimensions, T, stride, Is...>;
+		};
+
+		template<size_t dimensions, size_t tensorRank, typename TensorSymmetry, typename T>
+		struct Field_Tensor<PackedTensor<dimensions, tensorRank, TensorSymmetry, T>>
+		{
+			static constexpr size_t rank = tensorRank;
+			typedef TensorSymmetry Symmetry;
+			static constexpr size_t components = PackedTensor<dimensions, rank, Symmetry, T>::components;
+			template<size_t stride, typename... Is>
+			using Indexed = IndexedPackedTensor<rank, dimensions, T, stride, Symmetry, Is...>;
+		};
+
 		//dynamic single expression type
-		template<size_t dimensions, size_t divisions, size_t rank, typename T, typename... Is>
-		struct TensorFieldExpression<'s', dimensions, divisions, T, Tensor<dimensions, rank, T>, Is...>
+		template<size_t dimensions, typename Grid, typename T, typename TensorType, typename Layout, typename... Is>
+		struct TensorFieldExpression<'s', dimensions, Grid, T, TensorType, Layout, Is...>
 		{
-			typedef TensorFieldExpression<'s', dimensions, divisions, T, Tensor<dimensions, rank, T>, Is...> SelfType;
-			typedef Tensor<dimensions, rank, T> TensorType;
+			typedef TensorFieldExpression<'s', dimensions, Grid, T, TensorType, Layout, Is...> SelfType;
 
-			static constexpr size_t tensorDataSize = Template_Power<divisions, dimensions>::value;
+			static constexpr size_t pointStride = Layout::pointStride(Field_Tensor<TensorType>::components);
+			static constexpr size_t componentStride = Layout::componentStride(Grid::fixedPoints);
 
-			std::shared_ptr<TensorType[tensorDataSize]> tensorData;
+			Grid grid;
+			std::shared_ptr<T[]> scalarData;
 
-			TensorFieldExpression(const std::shared_ptr<TensorType[tensorDataSize]>& initData)
+			TensorFieldExpression(const Grid& initGrid, const std::shared_ptr<T[]>& initData)
 			:
-				tensorData(initData)
+				grid(initGrid),
+				scalarData(initData)
 			{}
 
 			TensorFieldExpression(const SelfType& other)
 			:
-				tensorData(other.tensorData)
+				grid(other.grid),
+				scalarData(other.scalarData)
 			{}
 
+			void checkGrid(const Grid& target) const
+			{
+				checkSameExtents(grid, target, "Field expressions must be on the same grid.");
+			}
+
 			template<char OtherID, typename... OtherIs>
-			SelfType& operator=(TensorFieldExpression<OtherID, dimensions, divisions, OtherIs...>&& other)
+			SelfType& operator=(TensorFieldExpression<OtherID, dimensions, Grid, OtherIs...>&& other)
 			{
-				for (size_t i = 0; i < tensorDataSize; ++i)
+				other.checkGrid(grid);
+				parallelFor(grid.points, [&](size_t begin, size_t end)
 				{
-					tensorData[i](Is()...) = other[i];
-				}
+					for (size_t i = begin; i < end; ++i)
+					{
+						(*this)[i] = other[i];
+					}
+				});
 				return *this;
 			}
 
 			SelfType& operator=(SelfType&& other)
 			{
-				for (size_t i = 0; i < tensorDataSize; ++i)
+				other.checkGrid(grid);
+				parallelFor(grid.points, [&](size_t begin, size_t end)
 				{
-					tensorData[i](Is()...) = other[i];
-				}
+					for (size_t i = begin; i < end; ++i)
+					{
+						(*this)[i] = other[i];
+					}
+				});
 				return *this;
 			}
 
 			template<char OtherID, typename... OtherIs>
-			SelfType& operator+=(TensorFieldExpression<OtherID, dimensions, divisions, OtherIs...>&& other)
+			SelfType& operator+=(TensorFieldExpression<OtherID, dimensions, Grid, OtherIs...>&& other)
 			{
-				for (size_t i = 0; i < tensorDataSize; ++i)
+				other.checkGrid(grid);
+				parallelFor(grid.points, [&](size_t begin, size_t end)
 				{
-					tensorData[i](Is()...) += other[i];
-				}
+					for (size_t i = begin; i < end; ++i)
+					{
+						(*this)[i] += other[i];
+					}
+				});
 				return *this;
 			}
 
 			template<char OtherID, typename... OtherIs>
-			SelfType& operator-=(TensorFieldExpression<OtherID, dimensions, divisions, OtherIs...>&& other)
+			SelfType& operator-=(TensorFieldExpression<OtherID, dimensions, Grid, OtherIs...>&& other)
 			{
-				for (size_t i = 0; i < tensorDataSize; ++i)
+				other.checkGrid(grid);
+				parallelFor(grid.points, [&](size_t begin, size_t end)
 				{
-					tensorData[i](Is()...) -= other[i];
-				}
+					for (size_t i = begin; i < end; ++i)
+					{
+						(*this)[i] -= other[i];
+					}
+				});
 				return *this;
 			}
 
+			//indexed view of the tensor at one grid point, whatever the layout
 			auto operator[](size_t index)
 			{
-				return tensorData[index](Is()...);
+				return Expression<'s', dimensions, T,
+					typename Template_Remove_Repeats<Is...>::T,
+					typename Field_Tensor<TensorType>::template Indexed<componentStride, Is...>,
+					typename Template_Get_Repeats<Is...>::T>(scalarData.get() + index * pointStride);
 			}
 		};
 
-		template<size_t dimensions, size_t divisions, typename T, char ID1, char ID2, typename... Is1, typename... Is2, typename Inverter>
-		struct TensorFieldExpression<'m', dimensions, divisions, T,
-			TensorFieldExpression<ID1, dimensions, divisions, T, Is1...>,
-			TensorFieldExpression<ID2, dimensions, divisions, T, Is2...>, Inverter>
+		//stencil and boundary treatment of a lazily evaluated gradient
+		template<typename Stencil, bool periodic>
+		struct GradientBoundary{};
+
+		//indexed gradient of a rank rank tensor field at one grid point (Is... has rank + 1 indices,
+		//the first being the derivative direction)
+		template<size_t rank, size_t dimensions, typename Grid, typename T, typename Layout,
+			typename Stencil, bool periodic, typename Symmetry, typename... Is>
+		struct IndexedGradient
+		{
+			static_assert(sizeof...(Is) == rank + 1, "Invalid number of indices on gradient.");
+		};
+
+		//the derivative version of Expression.
+		//each element asked for is computed from the stencil when it is asked for,
+		//so contracted or traced gradients only ever evaluate the derivatives they use.
+		//components of a packed (symmetric) field are read through its symmetry table.
+		template<size_t rank, size_t dimensions, typename Grid, typename T, typename Layout,
+			typename Stencil, bool periodic, typename Symmetry, typename... FreeIndices, typename... Is, typename... RepeatIs>
+		struct Expression<'d', dimensions, T, IndexPackType<FreeIndices...>,
+			IndexedGradient<rank, dimensions, Grid, T, Layout, Stencil, periodic, Symmetry, Is...>, IndexPackType<RepeatIs...>>
 		{
-			TensorFieldExpression<ID1, dimensions, divisions, T, Is1...> field1;
-			TensorFieldExpression<ID2, dimensions, divisions, T, Is2...> field2;
+			typedef Symmetry_Storage<dimensions, rank, Symmetry> Storage;
+			static constexpr size_t pointStride = Layout::pointStride(Storage::components);
+			static constexpr size_t componentStride = Layout::componentStride(Grid::fixedPoints);
+			static constexpr size_t radius = Stencil::radius;
+
+			const T* data;//component 0 of the undifferentiated tensor at this point
+			size_t point;
+			const Grid* grid;
+			const T* scales;//1 / (denominator * spacing) for each axis
+
+			template<typename Binding, typename AxisIndex, typename... ComponentIs, size_t... positions>
+			inline T derivative(std::index_sequence<positions...>) const
+			{
+				constexpr size_t axis = Template_Bound_Value<AxisIndex, Binding>::value;
+				constexpr size_t element = (0 + ... + (Template_Bound_Value<ComponentIs, Binding>::value
+					* Template_Power<dimensions, rank - 1 - positions>::value));
+				constexpr int sign = Storage::sign(element);
+				if constexpr (sign == 0)
+				{
+					return T();
+				}
+				const size_t divisions = grid->extents[axis];
+				const T* source = data + Storage::position(element) * componentStride;
+				T sum = T();
+				if constexpr (!Grid::rowMajor)
+				{
+					size_t position = grid->coordinate(point, axis);
+					bool inTile = false;
+					if constexpr (Grid::tile != 0)
+					{
+						//stencils that stay inside one tile step by the grid's stride
+						size_t inner = position % Grid::tile;
+						inTile = inner >= radius && inner + radius < Grid::tile;
+						if (inTile)
+						{
+							const std::ptrdiff_t neighbourStride = grid->stride(axis) * pointStride;
+							for (size_t k = 0; k < Stencil::width; ++k)
+							{
+								sum += T(Stencil::coefficients[radius][k]) * source[((std::ptrdiff_t)k - (std::ptrdiff_t)radius) * neighbourStride];
+							}
+						}
+					}
+					if (!inTile)
+					{
+						//otherwise (and in Morton order) neighbours are found through the grid's index mapping
+						size_t first = position - radius;
+						size_t v = radius;
+						if (!periodic && (position < radius || position >= divisions - radius))
+						{
+							v = position < radius ? position : 2 * radius - (divisions - 1 - position);
+							first = position - v;
+						}
+						for (size_t k = 0; k < Stencil::width; ++k)
+						{
+							size_t target = periodic ? (position + divisions + k - radius) % divisions : first + k;
+							sum += T(Stencil::coefficients[v][k]) * source[((std::ptrdiff_t)grid->moveTo(point, axis, target)
+								- (std::ptrdiff_t)point) * (std::ptrdiff_t)pointStride];
+						}
+					}
+				}
+				else
+				{
+					const size_t step = grid->stride(axis);
+					const std::ptrdiff_t neighbourStride = step * pointStride;
+
+					size_t position = point / step % divisions;
+					if (position >= radius && position < divisions - radius)
+					{
+						for (size_t k = 0; k < Stencil::width; ++k)
+						{
+							sum += T(Stencil::coefficients[radius][k]) * source[((std::ptrdiff_t)k - (std::ptrdiff_t)radius) * neighbourStride];
+						}
+					}
+					else if constexpr (periodic)
+					{
+						for (size_t k = 0; k < Stencil::width; ++k)
+						{
+							std::ptrdiff_t neighbour = (std::ptrdiff_t)((position + divisions + k - radius) % divisions) - (std::ptrdiff_t)position;
+							sum += T(Stencil::coefficients[radius][k]) * source[neighbour * neighbourStride];
+						}
+					}
+					else
+					{
+						size_t v = position < radius ? position : 2 * radius - (divisions - 1 - position);
+						for (size_t k = 0; k < Stencil::width; ++k)
+						{
+							sum += T(Stencil::coefficients[v][k]) * source[((std::ptrdiff_t)k - (std::ptrdiff_t)v) * neighbourStride];
+						}
+					}
+				}
+				return sign < 0 ? -sum * scales[axis] : sum * scales[axis];
+			}
+
+			template<typename Binding, typename AxisIndex, typename... ComponentIs>
+			inline T element() const
+			{
+				return derivative<Binding, AxisIndex, ComponentIs...>(std::index_sequence_for<ComponentIs...>());
+			}
+
+			//generic expression requirements
+
+			template<typename Binding>
+			inline T getValue() const
+			{
+				return Sum_Over<dimensions, T, Binding, RepeatIs...>::sum([this](auto binding)
+				{
+					return element<decltype(binding), Is...>();
+				});
+			}
+		};
+
+		//lazy gradient expression type, produces a derivative Expression per grid point
+		template<size_t dimensions, typename Grid, typename T, typename TensorType, typename Layout,
+			typename Stencil, bool periodic, typename... Is>
+		struct TensorFieldExpression<'g', dimensions, Grid, T, TensorType, Layout,
+			GradientBoundary<Stencil, periodic>, Is...>
+		{
+			static constexpr size_t rank = Field_Tensor<TensorType>::rank;
+			typedef typename Field_Tensor<TensorType>::Symmetry Symmetry;
+			static constexpr size_t pointStride = Layout::pointStride(Field_Tensor<TensorType>::components);
+
+			std::shared_ptr<T[]> scalarData;
+			Grid grid;
+			T scales[dimensions];
+
+			TensorFieldExpression(const std::shared_ptr<T[]>& initData, const Grid& initGrid, const T* initScales)
+			:
+				scalarData(initData),
+				grid(initGrid)
+			{
+				std::copy(initScales, initScales + dimensions, scales);
+			}
+
+			void checkGrid(const Grid& target) const
+			{
+				checkSameExtents(grid, target, "Field expressions must be on the same grid.");
+			}
+
+			auto operator[](size_t index)
+			{
+				return Expression<'d', dimensions, T,
+					typename Template_Remove_Repeats<Is...>::T,
+					IndexedGradient<rank, dimensions, Grid, T, Layout, Stencil, periodic, Symmetry, Is...>,
+					typename Template_Get_Repeats<Is...>::T>{scalarData.get() + index * pointStride, index, &grid, scales};
+			}
+		};
+
+		template<size_t dimensions, typename Grid, typename T, char ID1, char ID2, typename... Is1, typename... Is2, typename Inverter>
+		struct TensorFieldExpression<'m', dimensions, Grid, T,
+			TensorFieldExpression<ID1, dimensions, Grid, T, Is1...>,
+			TensorFieldExpression<ID2, dimensions, Grid, T, Is2...>, Inverter>
+		{
+			TensorFieldExpression<ID1, dimensions, Grid, T, Is1...> field1;
+			TensorFieldExpression<ID2, dimensions, Grid, T, Is2...> field2;
+
+			void checkGrid(const Grid& target) const
+			{
+				field1.checkGrid(target);
+				field2.checkGrid(target);
+			}
+
 			auto operator[](size_t index)
 			{
 				if constexpr (Inverter::value)
@@ -99,12 +339,19 @@ namespace SimulationUtilities{
 			}
 		};
 
-		template<size_t dimensions, size_t divisions, typename T, char ID1, char ID2, typename... Is1, typename... Is2, typename Inverter>
-		struct TensorFieldExpression<'a', dimensions, divisions, T, TensorFieldExpression<ID1, dimensions, divisions, T, Is1...>,
-			TensorFieldExpression<ID2, dimensions, divisions, T, Is2...>, Inverter>
+		template<size_t dimensions, typename Grid, typename T, char ID1, char ID2, typename... Is1, typename... Is2, typename Inverter>
+		struct TensorFieldExpression<'a', dimensions, Grid, T, TensorFieldExpression<ID1, dimensions, Grid, T, Is1...>,
+			TensorFieldExpression<ID2, dimensions, Grid, T, Is2...>, Inverter>
 		{
-			TensorFieldExpression<ID1, dimensions, divisions, T, Is1...> field1;
-			TensorFieldExpression<ID2, dimensions, divisions, T, Is2...> field2;
+			TensorFieldExpression<ID1, dimensions, Grid, T, Is1...> field1;
+			TensorFieldExpression<ID2, dimensions, Grid, T, Is2...> field2;
+
+			void checkGrid(const Grid& target) const
+			{
+				field1.checkGrid(target);
+				field2.checkGrid(target);
+			}
+
 			auto operator[](size_t index)
 			{
 				if constexpr (Inverter::value)
@@ -118,12 +365,18 @@ namespace SimulationUtilities{
 			}
 		};
 
-		template<size_t dimensions, size_t divisions, typename T, char ID, typename... Is, typename Inverter>
-		struct TensorFieldExpression<'m', dimensions, divisions, T,
-			TensorFieldExpression<ID, dimensions, divisions, T, Is...>, Inverter>
+		template<size_t dimensions, typename Grid, typename T, char ID, typename... Is, typename Inverter>
+		struct TensorFieldExpression<'m', dimensions, Grid, T,
+			TensorFieldExpression<ID, dimensions, Grid, T, Is...>, Inverter>
 		{
 			T multiplier;
-			TensorFieldExpression<ID, dimensions, divisions, T, Is...> field;
+			TensorFieldExpression<ID, dimensions, Grid, T, Is...> field;
+
+			void checkGrid(const Grid& target) const
+			{
+				field.checkGrid(target);
+			}
+
 			auto operator[](size_t index)
 			{
 				if constexpr (Inverter::value)
@@ -137,14 +390,20 @@ namespace SimulationUtilities{
 			}
 		};
 
-		template<size_t dimensions, size_t divisions, typename T, char ID, typename... Is,
+		template<size_t dimensions, typename Grid, typename T, char ID, typename... Is,
 			char OtherID, typename... OtherTs, typename Inverter>
-		struct TensorFieldExpression<'m', dimensions, divisions, T,
-			TensorFieldExpression<ID, dimensions, divisions, T, Is...>,
+		struct TensorFieldExpression<'m', dimensions, Grid, T,
+			TensorFieldExpression<ID, dimensions, Grid, T, Is...>,
 			Expression<OtherID, dimensions, OtherTs...>, Inverter>
 		{
 			Expression<OtherID, dimensions, OtherTs...> multiplier;
-			TensorFieldExpression<ID, dimensions, divisions, T, Is...> field;
+			TensorFieldExpression<ID, dimensions, Grid, T, Is...> field;
+
+			void checkGrid(const Grid& target) const
+			{
+				field.checkGrid(target);
+			}
+
 			auto operator[](size_t index)
 			{
 				if constexpr (Inverter::value)
@@ -158,12 +417,12 @@ namespace SimulationUtilities{
 			}
 		};
 
-		// template<size_t dimensions, size_t divisions, typename T, char ID, typename... Is, typename Inverter>
-		// struct TensorFieldExpression<'a', dimensions, divisions, T,
-		// 	TensorFieldExpression<ID, dimensions, divisions, T, Is...>, Inverter>
+		// template<size_t dimensions, typename Grid, typename T, char ID, typename... Is, typename Inverter>
+		// struct TensorFieldExpression<'a', dimensions, Grid, T,
+		// 	TensorFieldExpression<ID, dimensions, Grid, T, Is...>, Inverter>
 		// {
 		// 	T addition;
-		// 	TensorFieldExpression<ID, dimensions, divisions, T, Is...> field;
+		// 	TensorFieldExpression<ID, dimensions, Grid, T, Is...> field;
 		// 	auto operator[](size_t index)
 		// 	{
 		// 		if constexpr (Inverter::value)
@@ -177,14 +436,14 @@ namespace SimulationUtilities{
 		// 	}
 		// };
 
-		// template<size_t dimensions, size_t divisions, typename T, char ID, typename... Is,
+		// template<size_t dimensions, typename Grid, typename T, char ID, typename... Is,
 		// 	char OtherID, typename... OtherTs, typename Inverter>
-		// struct TensorFieldExpression<'a', dimensions, divisions, T,
-		// 	TensorFieldExpression<ID, dimensions, divisions, T, Is...>,
+		// struct TensorFieldExpression<'a', dimensions, Grid, T,
+		// 	TensorFieldExpression<ID, dimensions, Grid, T, Is...>,
 		// 	Expression<OtherID, dimensions, OtherTs...>, Inverter>
 		// {
 		// 	Expression<OtherID, dimensions, OtherTs...> addition;
-		// 	TensorFieldExpression<ID, dimensions, divisions, T, Is...> field;
+		// 	TensorFieldExpression<ID, dimensions, Grid, T, Is...> field;
 		// 	auto operator[](size_t index)
 		// 	{
 		// 		if constexpr (Inverter::value)
@@ -198,178 +457,261 @@ namespace SimulationUtilities{
 		// 	}
 		// };
 
-		template<size_t dimensions, size_t divisions, typename T, char ID1, char ID2, typename... Is1, typename... Is2>
-		TensorFieldExpression<'a', dimensions, divisions, T,
-			TensorFieldExpression<ID1, dimensions, divisions, T, Is1...>,
-			TensorFieldExpression<ID2, dimensions, divisions, T, Is2...>, InverseType<false>>
-		operator+(TensorFieldExpression<ID1, dimensions, divisions, T, Is1...> const& left,
-			TensorFieldExpression<ID2, dimensions, divisions, T, Is2...> const& right)
+		template<size_t dimensions, typename Grid, typename T, char ID1, char ID2, typename... Is1, typename... Is2>
+		TensorFieldExpression<'a', dimensions, Grid, T,
+			TensorFieldExpression<ID1, dimensions, Grid, T, Is1...>,
+			TensorFieldExpression<ID2, dimensions, Grid, T, Is2...>, InverseType<false>>
+		operator+(TensorFieldExpression<ID1, dimensions, Grid, T, Is1...> const& left,
+			TensorFieldExpression<ID2, dimensions, Grid, T, Is2...> const& right)
 		{
 			return {left, right};
 		}
 
-		template<size_t dimensions, size_t divisions, typename T, char ID1, char ID2, typename... Is1, typename... Is2>
-		TensorFieldExpression<'a', dimensions, divisions, T,
-			TensorFieldExpression<ID1, dimensions, divisions, T, Is1...>,
-			TensorFieldExpression<ID2, dimensions, divisions, T, Is2...>, InverseType<true>>
-		operator-(TensorFieldExpression<ID1, dimensions, divisions, T, Is1...> const& left,
-			TensorFieldExpression<ID2, dimensions, divisions, T, Is2...> const& right)
+		template<size_t dimensions, typename Grid, typename T, char ID1, char ID2, typename... Is1, typename... Is2>
+		TensorFieldExpression<'a', dimensions, Grid, T,
+			TensorFieldExpression<ID1, dimensions, Grid, T, Is1...>,
+			TensorFieldExpression<ID2, dimensions, Grid, T, Is2...>, InverseType<true>>
+		operator-(TensorFieldExpression<ID1, dimensions, Grid, T, Is1...> const& left,
+			TensorFieldExpression<ID2, dimensions, Grid, T, Is2...> const& right)
 		{
 			return {left, right};
 		}
 
-		template<size_t dimensions, size_t divisions, typename T, char ID1, char ID2, typename... Is1, typename... Is2>
-		TensorFieldExpression<'m', dimensions, divisions, T,
-			TensorFieldExpression<ID1, dimensions, divisions, T, Is1...>,
-			TensorFieldExpression<ID2, dimensions, divisions, T, Is2...>, InverseType<false>>
-		operator*(TensorFieldExpression<ID1, dimensions, divisions, T, Is1...> const& left,
-			TensorFieldExpression<ID2, dimensions, divisions, T, Is2...> const& right)
+		template<size_t dimensions, typename Grid, typename T, char ID1, char ID2, typename... Is1, typename... Is2>
+		TensorFieldExpression<'m', dimensions, Grid, T,
+			TensorFieldExpression<ID1, dimensions, Grid, T, Is1...>,
+			TensorFieldExpression<ID2, dimensions, Grid, T, Is2...>, InverseType<false>>
+		operator*(TensorFieldExpression<ID1, dimensions, Grid, T, Is1...> const& left,
+			TensorFieldExpression<ID2, dimensions, Grid, T, Is2...> const& right)
 		{
 			return {left, right};
 		}
 
-		template<size_t dimensions, size_t divisions, typename T, char ID1, char ID2, typename... Is1, typename... Is2>
-		TensorFieldExpression<'m', dimensions, divisions, T,
-			TensorFieldExpression<ID1, dimensions, divisions, T, Is1...>,
-			TensorFieldExpression<ID2, dimensions, divisions, T, Is2...>, InverseType<true>>
-		operator/(TensorFieldExpression<ID1, dimensions, divisions, T, Is1...> const& left,
-			TensorFieldExpression<ID2, dimensions, divisions, T, Is2...> const& right)
+		template<size_t dimensions, typename Grid, typename T, char ID1, char ID2, typename... Is1, typename... Is2>
+		TensorFieldExpression<'m', dimensions, Grid, T,
+			TensorFieldExpression<ID1, dimensions, Grid, T, Is1...>,
+			TensorFieldExpression<ID2, dimensions, Grid, T, Is2...>, InverseType<true>>
+		operator/(TensorFieldExpression<ID1, dimensions, Grid, T, Is1...> const& left,
+			TensorFieldExpression<ID2, dimensions, Grid, T, Is2...> const& right)
 		{
 			return {left, right};
 		}
 
-		// template<size_t dimensions, size_t divisions, typename T, char ID,
+		// template<size_t dimensions, typename Grid, typename T, char ID,
 		// 	char OtherID, typename... OtherTs, typename... Is>
-		// TensorFieldExpression<'a', dimensions, divisions, T,
-		// 	TensorFieldExpression<ID, dimensions, divisions, T, Is...>,
+		// TensorFieldExpression<'a', dimensions, Grid, T,
+		// 	TensorFieldExpression<ID, dimensions, Grid, T, Is...>,
 		// 	Expression<OtherID, dimensions, OtherTs...>, InverseType<false>>
-		// operator+(TensorFieldExpression<ID, dimensions, divisions, T, Is...> const& left,
+		// operator+(TensorFieldExpression<ID, dimensions, Grid, T, Is...> const& left,
 		// 	Expression<OtherID, dimensions, OtherTs...> const& right)
 		// {
 		// 	return {right, left};
 		// }
 
-		// template<size_t dimensions, size_t divisions, typename T, char ID,
+		// template<size_t dimensions, typename Grid, typename T, char ID,
 		// 	char OtherID, typename... OtherTs, typename... Is>
-		// TensorFieldExpression<'a', dimensions, divisions, T,
-		// 	TensorFieldExpression<ID, dimensions, divisions, T, Is...>,
+		// TensorFieldExpression<'a', dimensions, Grid, T,
+		// 	TensorFieldExpression<ID, dimensions, Grid, T, Is...>,
 		// 	Expression<OtherID, dimensions, OtherTs...>, InverseType<false>>
 		// operator+(Expression<OtherID, dimensions, OtherTs...> const& left,
-		// 	TensorFieldExpression<ID, dimensions, divisions, T, Is...> const& right)
+		// 	TensorFieldExpression<ID, dimensions, Grid, T, Is...> const& right)
 		// {
 		// 	return {left, right};
 		// }
 
-		// template<size_t dimensions, size_t divisions, typename T, char ID,
+		// template<size_t dimensions, typename Grid, typename T, char ID,
 		// 	char OtherID, typename... OtherTs, typename... Is>
-		// TensorFieldExpression<'a', dimensions, divisions, T,
-		// 	TensorFieldExpression<ID, dimensions, divisions, T, Is...>,
+		// TensorFieldExpression<'a', dimensions, Grid, T,
+		// 	TensorFieldExpression<ID, dimensions, Grid, T, Is...>,
 		// 	Expression<OtherID, dimensions, OtherTs...>, InverseType<true>>
-		// operator-(TensorFieldExpression<ID, dimensions, divisions, T, Is...> const& left,
+		// operator-(TensorFieldExpression<ID, dimensions, Grid, T, Is...> const& left,
 		// 	Expression<OtherID, dimensions, OtherTs...> const& right)
 		// {
 		// 	return {right, left};
 		// }
 
-		template<size_t dimensions, size_t divisions, typename T, char ID,
+		template<size_t dimensions, typename Grid, typename T, char ID,
 			char OtherID, typename... OtherTs, typename... Is>
-		TensorFieldExpression<'a', dimensions, divisions, T,
-			TensorFieldExpression<ID, dimensions, divisions, T, Is...>,
+		TensorFieldExpression<'m', dimensions, Grid, T,
+			TensorFieldExpression<ID, dimensions, Grid, T, Is...>,
 			Expression<OtherID, dimensions, OtherTs...>, InverseType<false>>
-		operator*(TensorFieldExpression<ID, dimensions, divisions, T, Is...> const& left,
+		operator*(TensorFieldExpression<ID, dimensions, Grid, T, Is...> const& left,
 			Expression<OtherID, dimensions, OtherTs...> const& right)
 		{
 			return {right, left};
 		}
 
-		template<size_t dimensions, size_t divisions, typename T, char ID,
+		template<size_t dimensions, typename Grid, typename T, char ID,
 			char OtherID, typename... OtherTs, typename... Is>
-		TensorFieldExpression<'m', dimensions, divisions, T,
-			TensorFieldExpression<ID, dimensions, divisions, T, Is...>,
+		TensorFieldExpression<'m', dimensions, Grid, T,
+			TensorFieldExpression<ID, dimensions, Grid, T, Is...>,
 			Expression<OtherID, dimensions, OtherTs...>, InverseType<false>>
 		operator*(Expression<OtherID, dimensions, OtherTs...> const& left,
-			TensorFieldExpression<ID, dimensions, divisions, T, Is...> const& right)
+			TensorFieldExpression<ID, dimensions, Grid, T, Is...> const& right)
 		{
 			return {left, right};
 		}
 
-		template<size_t dimensions, size_t divisions, typename T, char ID,
+		template<size_t dimensions, typename Grid, typename T, char ID,
 			char OtherID, typename... OtherTs, typename... Is>
-		TensorFieldExpression<'m', dimensions, divisions, T,
-			TensorFieldExpression<ID, dimensions, divisions, T, Is...>,
+		TensorFieldExpression<'m', dimensions, Grid, T,
+			TensorFieldExpression<ID, dimensions, Grid, T, Is...>,
 			Expression<OtherID, dimensions, OtherTs...>, InverseType<true>>
-		operator/(TensorFieldExpression<ID, dimensions, divisions, T, Is...> const& left,
+		operator/(TensorFieldExpression<ID, dimensions, Grid, T, Is...> const& left,
 			Expression<OtherID, dimensions, OtherTs...> const& right)
 		{
 			return {right, left};
 		}
 
-		template<size_t dimensions, size_t divisions, typename T, char ID, typename... Is>
-		TensorFieldExpression<'m', dimensions, divisions, T,
-			TensorFieldExpression<ID, dimensions, divisions, T, Is...>, InverseType<false>>
-		operator*(TensorFieldExpression<ID, dimensions, divisions, T, Is...> const& left, T const& right)
+		template<size_t dimensions, typename Grid, typename T, char ID, typename... Is>
+		TensorFieldExpression<'m', dimensions, Grid, T,
+			TensorFieldExpression<ID, dimensions, Grid, T, Is...>, InverseType<false>>
+		operator*(TensorFieldExpression<ID, dimensions, Grid, T, Is...> const& left, typename Template_Identity<T>::T const& right)
 		{
 			return {right, left};
 		}
 
-		template<size_t dimensions, size_t divisions, typename T, char ID, typename... Is>
-		TensorFieldExpression<'m', dimensions, divisions, T,
-			TensorFieldExpression<ID, dimensions, divisions, T, Is...>, InverseType<false>>
-		operator*(T const& left, TensorFieldExpression<ID, dimensions, divisions, T, Is...> const& right)
+		template<size_t dimensions, typename Grid, typename T, char ID, typename... Is>
+		TensorFieldExpression<'m', dimensions, Grid, T,
+			TensorFieldExpression<ID, dimensions, Grid, T, Is...>, InverseType<false>>
+		operator*(typename Template_Identity<T>::T const& left, TensorFieldExpression<ID, dimensions, Grid, T, Is...> const& right)
 		{
 			return {left, right};
 		}
 
-		template<size_t dimensions, size_t divisions, typename T, char ID, typename... Is>
-		TensorFieldExpression<'m', dimensions, divisions, T,
-			TensorFieldExpression<ID, dimensions, divisions, T, Is...>, InverseType<true>>
-		operator/(TensorFieldExpression<ID, dimensions, divisions, T, Is...> const& left, T const& right)
+		template<size_t dimensions, typename Grid, typename T, char ID, typename... Is>
+		TensorFieldExpression<'m', dimensions, Grid, T,
+			TensorFieldExpression<ID, dimensions, Grid, T, Is...>, InverseType<true>>
+		operator/(TensorFieldExpression<ID, dimensions, Grid, T, Is...> const& left, typename Template_Identity<T>::T const& right)
 		{
 			return {right, left};
 		}
 	}
 
-	template<size_t dimensions, size_t rank, size_t divisions, typename T>
-	class TensorField<dimensions, rank, divisions, T>
+	//tensor field on any Extents grid (TensorField is the uniform case).
+	//with a Symmetry other than NoSymmetry each point stores a PackedTensor (only the independent components)
+	template<typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	class GridTensorField
 	{
-		static constexpr size_t tensorDataSize = Template_Power<divisions, dimensions>::value;
+		static_assert(Grid::dimensions != 0, "Grid must have at least one axis.");
+		static_assert(!Grid::fixed || Grid::smallestExtent > 4, "Every axis needs at least 5 points.");
+		static_assert(Grid::fixed || !Layout::componentMajor, "ComponentMajor storage needs a compile time grid.");
 
-		typedef TensorField<dimensions, rank, divisions, T> SelfType;
-		typedef Tensor<dimensions, rank, T> TensorType;
-		std::shared_ptr<TensorType[tensorDataSize]> tensorData;
+		static constexpr size_t dimensions = Grid::dimensions;
+		static constexpr size_t components = Symmetry_Storage<dimensions, rank, Symmetry>::components;
+		static constexpr size_t pointStride = Layout::pointStride(components);
+		static constexpr size_t componentStride = Layout::componentStride(Grid::fixedPoints);
+
+		typedef GridTensorField<Grid, rank, T, Layout, Symmetry> SelfType;
+		typedef typename Symmetry_Tensor<dimensions, rank, T, Symmetry>::T TensorType;
+		Grid grid;
+		std::shared_ptr<T[]> scalarData;
+
+		size_t scalarDataSize() const
+		{
+			return grid.points * components;
+		}
+
+		template<typename, size_t, typename, typename, typename, bool, typename>
+		friend class LazyGradient;
+
+		//runs a simd kernel over the flat scalar buffer, split across the parallel execution threads
+		template<typename Operation, typename Other>
+		void applyFlat(Other other)
+		{
+			T* data = scalarData.get();
+			parallelFor(scalarDataSize(), [&](size_t begin, size_t end)
+			{
+				if constexpr (std::is_pointer<Other>::value)
+				{
+					simdApply<Operation>(data + begin, other + begin, end - begin);
+				}
+				else
+				{
+					simdApply<Operation>(data + begin, other, end - begin);
+				}
+			});
+		}
 	public:
-		TensorField()
+		GridTensorField()
+		:
+			scalarData(pooledArray<T>(scalarDataSize(), true))
+		{}
+		//the grid only needs passing in for run time (DynamicExtents) grids
+		GridTensorField(const Grid& initGrid)
+		:
+			grid(initGrid),
+			scalarData(pooledArray<T>(scalarDataSize(), true))
+		{}
+		GridTensorField(const std::vector<TensorType>& input, const Grid& initGrid = Grid())
 		:
-			tensorData(new TensorType[tensorDataSize])
+			grid(initGrid),
+			scalarData(pooledArray<T>(scalarDataSize(), true))
 		{
-			for (size_t i = 0; i < tensorDataSize; ++i)
+			for (size_t i = 0; i < input.size(); ++i)
 			{
-				tensorData[i] = TensorType();
+				setTensor(i, input[i]);
 			}
 		}
-		TensorField(const std::vector<TensorType>& input)
+
+		//uses storage (at least size() * components scalars, e.g. a mapped checkpoint) without copying it
+		GridTensorField(const Grid& initGrid, const std::shared_ptr<T[]>& storage)
 		:
-			tensorData(new TensorType[tensorDataSize])
-		{
-			std::copy(input.begin(), input.end(), tensorData);
-		}
+			grid(initGrid),
+			scalarData(storage)
+		{}
 
-		TensorField(SelfType&& other) = default;
+		GridTensorField(SelfType&& other) = default;
 		// :
 		// 	tensorData(other.tensorData)
 		// {}
 
-		TensorField(const SelfType& other)
+		GridTensorField(const SelfType& other)
+		:
+			grid(other.grid),
+			scalarData(pooledArray<T>(scalarDataSize(), false))
+		{
+			std::copy(other.scalarData.get(), other.scalarData.get() + scalarDataSize(), scalarData.get());
+		}
+
+		//copy of a field with another scalar type (e.g. float storage of a double field and back)
+		template<typename S, typename = std::enable_if_t<!std::is_same<S, T>::value>>
+		explicit GridTensorField(const GridTensorField<Grid, rank, S, Layout, Symmetry>& other)
 		:
-			tensorData(new TensorType[tensorDataSize])
+			grid(other.getGrid()),
+			scalarData(pooledArray<T>(scalarDataSize(), false))
 		{
-			std::copy(other.tensorData.get(), other.tensorData.get() + tensorDataSize, tensorData.get());
+			T* data = scalarData.get();
+			const S* otherData = other.getData();
+			parallelFor(scalarDataSize(), [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					data[i] = T(otherData[i]);
+				}
+			});
 		}
 
+		//reuses the current buffer when it has the right size and nothing else (an expression
+		//or lazy gradient) still holds it, so repeated assignments do not allocate
 		SelfType& operator=(const SelfType& other)
 		{
-			tensorData = std::shared_ptr<TensorType[tensorDataSize]>(new TensorType[tensorDataSize]);
-			std::copy(other.tensorData.get(), other.tensorData.get() + tensorDataSize, tensorData.get());
+			if (this == &other)
+			{
+				return *this;
+			}
+			bool reuse = scalarData.use_count() == 1 && scalarDataSize() == other.scalarDataSize();
+			grid = other.grid;
+			if (!reuse)
+			{
+				scalarData = pooledArray<T>(scalarDataSize(), false);
+			}
+			T* data = scalarData.get();
+			const T* otherData = other.scalarData.get();
+			parallelFor(scalarDataSize(), [&](size_t begin, size_t end)
+			{
+				std::copy(otherData + begin, otherData + end, data + begin);
+			});
 			return *this;
 		}
 		SelfType& operator=(SelfType&& other) = default;
@@ -377,245 +719,375 @@ namespace SimulationUtilities{
 		template<typename... IndexIdentifiers>
 		auto operator()(IndexIdentifiers... indices) const//make constant tensorData Expression
 		{
-			return TensorFieldExpression<'s', dimensions, divisions, T, TensorType, IndexIdentifiers...>(tensorData);
+			return TensorFieldExpression<'s', dimensions, Grid, T, TensorType, Layout, IndexIdentifiers...>(grid, scalarData);
 		}
 
+		//the compound operators treat the whole field as one flat buffer of scalars
+
 		SelfType& operator+=(const SelfType& other)
 		{
-			for (size_t i = 0; i < tensorDataSize; ++i)
-			{
-				tensorData[i] += other.tensorData[i];
-			}
+			checkSameExtents(grid, other.grid, "Fields must be on the same grid.");
+			applyFlat<SimdAdd>((const T*)other.scalarData.get());
 			return *this;
 		}
 		SelfType& operator-=(const SelfType& other)
 		{
-			for (size_t i = 0; i < tensorDataSize; ++i)
-			{
-				tensorData[i] -= other.tensorData[i];
-			}
+			checkSameExtents(grid, other.grid, "Fields must be on the same grid.");
+			applyFlat<SimdSubtract>((const T*)other.scalarData.get());
 			return *this;
 		}
 		SelfType& operator*=(double other){
-			for (size_t i = 0; i < tensorDataSize; ++i)
+			if constexpr (std::is_floating_point<T>::value)
 			{
-				tensorData[i] *= other;
+				applyFlat<SimdMultiply>(T(other));
+			}
+			else
+			{
+				T* data = scalarData.get();
+				parallelFor(scalarDataSize(), [&](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++i)
+					{
+						data[i] *= other;
+					}
+				});
 			}
 			return *this;
 		}
 		SelfType& operator/=(double other){
-			for (size_t i = 0; i < tensorDataSize; ++i)
+			if constexpr (std::is_floating_point<T>::value)
 			{
-				tensorData[i] /= other;
+				applyFlat<SimdDivide>(T(other));
+			}
+			else
+			{
+				T* data = scalarData.get();
+				parallelFor(scalarDataSize(), [&](size_t begin, size_t end)
+				{
+					for (size_t i = begin; i < end; ++i)
+					{
+						data[i] /= other;
+					}
+				});
 			}
 			return *this;
 		}
 
+		//direct tensor references only exist when each point's tensor is contiguous,
+		//getTensor and setTensor work with either layout
+
 		TensorType& operator[](size_t index)
 		{
-			return tensorData[index];
+			static_assert(!Layout::componentMajor, "operator[] needs PointMajor storage, use getTensor/setTensor.");
+			return *(TensorType*)(scalarData.get() + index * pointStride);
 		}
 
 		const TensorType& operator[](size_t index) const
 		{
-			return tensorData[index];
+			static_assert(!Layout::componentMajor, "operator[] needs PointMajor storage, use getTensor/setTensor.");
+			return *(const TensorType*)(scalarData.get() + index * pointStride);
+		}
+
+		TensorType getTensor(size_t index) const
+		{
+			TensorType output;
+			for (size_t c = 0; c < components; ++c)
+			{
+				output.getData()[c] = scalarData[index * pointStride + c * Layout::componentStride(grid.points)];
+			}
+			return output;
+		}
+
+		void setTensor(size_t index, const TensorType& value)
+		{
+			for (size_t c = 0; c < components; ++c)
+			{
+				scalarData[index * pointStride + c * Layout::componentStride(grid.points)] = value.getData()[c];
+			}
 		}
 
 		template<size_t dimension>
 		static inline size_t stepSize()
 		{
-			return Template_Power<divisions, dimensions - dimension - 1>::value;
+			return Grid::stride(dimension);
+		}
+
+		size_t stride(size_t axis) const
+		{
+			return grid.stride(axis);
+		}
+
+		const Grid& getGrid() const
+		{
+			return grid;
+		}
+
+		size_t size() const
+		{
+			return grid.points;
+		}
+
+		T* getData()
+		{
+			return scalarData.get();
+		}
+
+		const T* getData() const
+		{
+			return scalarData.get();
 		}
 
 		const TensorType* begin() const
 		{
-			return tensorData.get();
+			static_assert(!Layout::componentMajor, "begin() needs PointMajor storage, use getData.");
+			return (const TensorType*)scalarData.get();
 		}
 
 		const TensorType* end() const
 		{
-			return tensorData.get() + tensorDataSize;
+			static_assert(!Layout::componentMajor, "end() needs PointMajor storage, use getData.");
+			return (const TensorType*)scalarData.get() + grid.points;
 		}
 	};
 
-	template<size_t dimensions, size_t rank, size_t divisions, typename T>
-	auto operator+(TensorField<dimensions, rank, divisions, T> left,
-		const TensorField<dimensions, rank, divisions, T>& right)
+	//the by value operators return their (moved) parameter, so each makes one copy
+	//(none when called with a temporary)
+
+	template<typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	auto operator+(GridTensorField<Grid, rank, T, Layout, Symmetry> left,
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& right)
 	{
-		return left += right;
+		left += right;
+		return left;
 	}
 
-	template<size_t dimensions, size_t rank, size_t divisions, typename T>
-	auto operator-(TensorField<dimensions, rank, divisions, T> left,
-		const TensorField<dimensions, rank, divisions, T>& right)
+	template<typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	auto operator-(GridTensorField<Grid, rank, T, Layout, Symmetry> left,
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& right)
 	{
-		return left -= right;
+		left -= right;
+		return left;
 	}
 
-	template<size_t dimensions, size_t rank, size_t divisions, typename T>
-	auto operator*(TensorField<dimensions, rank, divisions, T> left, const T& right)
+	template<typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	auto operator*(GridTensorField<Grid, rank, T, Layout, Symmetry> left, const typename Template_Identity<T>::T& right)
 	{
-		return left *= right;
+		left *= right;
+		return left;
 	}
 
-	template<size_t dimensions, size_t rank, size_t divisions, typename T>
-	auto operator*(const T& left, TensorField<dimensions, rank, divisions, T> right)
+	template<typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	auto operator*(const typename Template_Identity<T>::T& left, GridTensorField<Grid, rank, T, Layout, Symmetry> right)
 	{
-		return right *= left;
+		right *= left;
+		return right;
 	}
 
-	template<size_t dimensions, size_t rank, size_t divisions, typename T>
-	auto operator/(TensorField<dimensions, rank, divisions, T> left, const T& right)
+	template<typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	auto operator/(GridTensorField<Grid, rank, T, Layout, Symmetry> left, const typename Template_Identity<T>::T& right)
 	{
-		return left /= right;
+		left /= right;
+		return left;
 	}
 
-	template<size_t dimensions, size_t rank, size_t divisions, typename T>
-	TensorField<dimensions, rank + 1, divisions, T> gradient_ignoreBoundary(
-		const TensorField<dimensions, rank, divisions, T>& input, double dx)
+	namespace
 	{
-		//perform a fourth order gradient on a tensor field, producing a rank n+1 tensor field
-		//where the last index (though no indices are used here) is the derivative direction.
+		//rank n+1 tensor field of the derivatives along every axis of a tensor field (the first index,
+		//though no indices are used here, is the derivative direction), computed with Stencil.
+		//the symmetric indices of a packed input stay packed (Symmetric<n> gives Symmetric<n + 1>).
+		template<typename Stencil, bool periodic, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+		GridTensorField<Grid, rank + 1, T, Layout, typename Gradient_Symmetry<Symmetry>::T> applyDerivativeStencil(
+			const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+		{
+			static_assert(!Grid::fixed || Grid::smallestExtent >= Stencil::width, "Every axis needs at least order + 1 points for this stencil.");
 
-		typedef Tensor<dimensions, rank, T> TensorType;
-		typedef Tensor<dimensions, rank + 1, T> NewTensorType;
-		typedef TensorField<dimensions, rank, divisions, T> InputType;
-		typedef TensorField<dimensions, rank + 1, divisions, T> OutputType;
+			GridTensorField<Grid, rank + 1, T, Layout, typename Gradient_Symmetry<Symmetry>::T> output(input.getGrid());
 
-		OutputType output;
-		NewTensorType* outputData = (NewTensorType*)(output.begin());
-		const TensorType* inputData = input.begin();
+			if constexpr (Grid::rowMajor)
+			{
+				GradientStencilEngine<Grid::dimensions, Symmetry_Storage<Grid::dimensions, rank, Symmetry>::components, T, Stencil, periodic, Layout>
+					(input.getGrid().extents, spacing.data()).apply(input.getData(), output.getData());
+			}
+			else
+			{
+				OrderedGradientStencilEngine<Grid, Symmetry_Storage<Grid::dimensions, rank, Symmetry>::components, T, Stencil, periodic, Layout>
+					(input.getGrid(), spacing.data()).apply(input.getData(), output.getData());
+			}
 
-		size_t incr = 1;
+			return output;
+		}
 
-		for (size_t dim = dimensions; dim > 0; --dim, incr *= divisions)
+		template<size_t dimensions>
+		std::array<double, dimensions> uniformSpacing(double dx)
 		{
-			// size_t tensorDataOffset = (dim - 1) * Template_Power<dimensions, rank>::value;
-			size_t tensorDataOffset = dim - 1;
-
-			for (size_t i = 0; i < Template_Power<divisions, dimensions>::value; ++i)
-			{
-				size_t dimensionPosition = i / incr % divisions;
-
-				if (dimensionPosition > 1)
-				{
-					if (dimensionPosition < divisions - 2)
-					{
-						//standard 4th order algorithm
-						const TensorType* neg2 = inputData + i - incr * 2;
-						const TensorType* neg1 = inputData + i - incr;
-						const TensorType* pos1 = inputData + i + incr;
-						const TensorType* pos2 = inputData + i + incr * 2;
-						*((TensorType*)(outputData + i) + tensorDataOffset) = (8 * (*pos1 - *neg1) - *pos2 + *neg2)/(12 * dx);
-					}
-					else
-					{
-						//close to end
-						if (dimensionPosition == divisions - 1)
-						{
-							//at end
-							const TensorType* neg4 = inputData + i - incr * 4;
-							const TensorType* neg3 = inputData + i - incr * 3;
-							const TensorType* neg2 = inputData + i - incr * 2;
-							const TensorType* neg1 = inputData + i - incr;
-							const TensorType* p0 = inputData + i;
-							*((TensorType*)(outputData + i) + tensorDataOffset)
-								= (25 * *p0 - 48 * *neg1 + 36 * *neg2 - 16 * *neg3 + 3 * *neg4)/(12 * dx);
-						}
-						else
-						{
-							//one from end
-							const TensorType* neg3 = inputData + i - incr * 3;
-							const TensorType* neg2 = inputData + i - incr * 2;
-							const TensorType* neg1 = inputData + i - incr;
-							const TensorType* p0 = inputData + i;
-							const TensorType* pos1 = inputData + i + incr;
-							*((TensorType*)(outputData + i) + tensorDataOffset)
-								= (3 * *pos1 - *neg3 + 6 * *neg2 + 10 * *p0 - 18 * *neg1)/(12 * dx);
-						}
-					}
-				}
-				else
-				{
-					//close to start
-					if (dimensionPosition == 0)
-					{
-						//at start
-						const TensorType* pos4 = inputData + i + incr * 4;
-						const TensorType* pos3 = inputData + i + incr * 3;
-						const TensorType* pos2 = inputData + i + incr * 2;
-						const TensorType* pos1 = inputData + i + incr;
-						const TensorType* p0 = inputData + i;
-						*((TensorType*)(outputData + i) + tensorDataOffset)
-							= (-25 * *p0 + 48 * *pos1 - 36 * *pos2 + 16 * *pos3 - 3 * *pos4)/(12 * dx);
-					}
-					else
-					{
-						//one from start
-						const TensorType* pos3 = inputData + i + incr * 3;
-						const TensorType* pos2 = inputData + i + incr * 2;
-						const TensorType* pos1 = inputData + i + incr;
-						const TensorType* p0 = inputData + i;
-						const TensorType* neg1 = inputData + i - incr;
-						*((TensorType*)(outputData + i) + tensorDataOffset)
-							= (-3 * *neg1 + *pos3 - 6 * *pos2 - 10 * *p0 + 18 * *pos1)/(12 * dx);
-					}
-				}
-			}
+			std::array<double, dimensions> spacing;
+			spacing.fill(dx);
+			return spacing;
 		}
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank + 1, T, Layout, typename Gradient_Symmetry<Symmetry>::T> gradient_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//perform an order'th order (4 by default) gradient on a tensor field, producing a rank n+1 tensor field
+		//where the first index is the derivative direction.
+		//points within order / 2 of a boundary use one sided stencils. spacing is the grid spacing along each axis.
+		return applyDerivativeStencil<FiniteDifferenceStencil<1, order>, false>(input, spacing);
+	}
 
-		return output;
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank + 1, T, Layout, typename Gradient_Symmetry<Symmetry>::T> gradient_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return gradient_ignoreBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
 	}
 
-	template<size_t dimensions, size_t rank, size_t divisions, typename T>
-	TensorField<dimensions, rank + 1, divisions, T> gradient_periodicBoundary(
-		const TensorField<dimensions, rank, divisions, T>& input, double dx)
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank + 1, T, Layout, typename Gradient_Symmetry<Symmetry>::T> gradient_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
 	{
-		//perform a fourth order gradient on a tensor field, producing a rank n+1 tensor field
-		//where the last index (though no indices are used here) is the derivative direction.
+		//perform an order'th order (4 by default) gradient on a tensor field, producing a rank n+1 tensor field
+		//where the first index is the derivative direction.
 		//the boundaries use the opposite side to create periodic boundary conditions
+		return applyDerivativeStencil<FiniteDifferenceStencil<1, order>, true>(input, spacing);
+	}
 
-		typedef Tensor<dimensions, rank, T> TensorType;
-		typedef Tensor<dimensions, rank + 1, T> NewTensorType;
-		typedef TensorField<dimensions, rank, divisions, T> InputType;
-		typedef TensorField<dimensions, rank + 1, divisions, T> OutputType;
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank + 1, T, Layout, typename Gradient_Symmetry<Symmetry>::T> gradient_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return gradient_periodicBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
+	}
 
-		OutputType output;
-		NewTensorType* outputData = (NewTensorType*)(output.begin());
-		const TensorType* inputData = input.begin();
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank + 1, T, Layout, typename Gradient_Symmetry<Symmetry>::T> secondDerivative_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//second derivative along each axis (the diagonal of the hessian), laid out like the gradient:
+		//the first index is the axis. one sided stencils near the boundaries are one order lower.
+		return applyDerivativeStencil<FiniteDifferenceStencil<2, order>, false>(input, spacing);
+	}
 
-		size_t incr = 1;
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank + 1, T, Layout, typename Gradient_Symmetry<Symmetry>::T> secondDerivative_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return secondDerivative_ignoreBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
+	}
 
-		for (size_t dim = dimensions; dim > 0; --dim, incr *= divisions)
-		{
-			// size_t tensorDataOffset = (dim - 1) * Template_Power<dimensions, rank>::value;
-			size_t tensorDataOffset = dim - 1;
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank + 1, T, Layout, typename Gradient_Symmetry<Symmetry>::T> secondDerivative_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//periodic version of secondDerivative_ignoreBoundary
+		return applyDerivativeStencil<FiniteDifferenceStencil<2, order>, true>(input, spacing);
+	}
 
-			for (size_t i = 0; i < Template_Power<divisions, dimensions>::value; ++i)
-			{
-				size_t dimensionPosition = i / incr % divisions;
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	GridTensorField<Grid, rank + 1, T, Layout, typename Gradient_Symmetry<Symmetry>::T> secondDerivative_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return secondDerivative_periodicBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
+	}
 
-				if (dimensionPosition > 1 && dimensionPosition < divisions - 2)
-				{
-					//standard 4th order algorithm
-					const TensorType* neg2 = inputData + i - incr * 2;
-					const TensorType* neg1 = inputData + i - incr;
-					const TensorType* pos1 = inputData + i + incr;
-					const TensorType* pos2 = inputData + i + incr * 2;
-					*((TensorType*)(outputData + i) + tensorDataOffset) = (8 * (*pos1 - *neg1) - *pos2 + *neg2)/(12 * dx);
-				}
-				else
-				{
-					const TensorType* neg2 = inputData + i + incr * ((dimensionPosition - 2 + divisions) % divisions - dimensionPosition);
-					const TensorType* neg1 = inputData + i + incr * ((dimensionPosition - 1 + divisions) % divisions - dimensionPosition);
-					const TensorType* pos1 = inputData + i + incr * ((dimensionPosition + 1) % divisions - dimensionPosition);
-					const TensorType* pos2 = inputData + i + incr * ((dimensionPosition + 2) % divisions - dimensionPosition);
-					*((TensorType*)(outputData + i) + tensorDataOffset) = (8 * (*pos1 - *neg1) - *pos2 + *neg2)/(12 * dx);
-				}
+	//gradient of a tensor field that is only evaluated inside field expressions.
+	//index it like a TensorField of rank + 1 (derivative direction first), for example
+	//divergence D() = grad(i, i) or advection A(i) = v(j) * grad(i, j), and each statement
+	//runs as one sweep without building the rank + 1 field. it refers to the input's storage,
+	//so later changes to the input show up in later evaluations. with a second derivative Stencil
+	//it gives the second derivative along each axis instead.
+	template<typename Grid, size_t rank, typename T, typename Layout, typename Stencil, bool periodic, typename Symmetry>
+	class LazyGradient
+	{
+		static constexpr size_t dimensions = Grid::dimensions;
+
+		std::shared_ptr<T[]> scalarData;
+		Grid grid;
+		T scales[dimensions];
+	public:
+		LazyGradient(const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, dimensions>& spacing)
+		:
+			scalarData(input.scalarData),
+			grid(input.grid)
+		{
+			checkStencilExtents<Stencil>(grid.extents, dimensions);
+			for (size_t axis = 0; axis < dimensions; ++axis)
+			{
+				scales[axis] = T(1 / (Stencil::denominator * Stencil::spacingPower(spacing[axis])));
 			}
 		}
 
-		return output;
+		template<typename... IndexIdentifiers>
+		auto operator()(IndexIdentifiers... indices) const
+		{
+			return TensorFieldExpression<'g', dimensions, Grid, T, typename Symmetry_Tensor<dimensions, rank, T, Symmetry>::T, Layout,
+				GradientBoundary<Stencil, periodic>, IndexIdentifiers...>(scalarData, grid, scales);
+		}
+	};
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	LazyGradient<Grid, rank, T, Layout, FiniteDifferenceStencil<1, order>, false, Symmetry> lazyGradient_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//lazy version of gradient_ignoreBoundary
+		static_assert(!Grid::fixed || Grid::smallestExtent >= 2 * (order / 2) + 1, "Every axis needs at least order + 1 points for this stencil.");
+		return {input, spacing};
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	LazyGradient<Grid, rank, T, Layout, FiniteDifferenceStencil<1, order>, false, Symmetry> lazyGradient_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return lazyGradient_ignoreBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	LazyGradient<Grid, rank, T, Layout, FiniteDifferenceStencil<1, order>, true, Symmetry> lazyGradient_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//lazy version of gradient_periodicBoundary
+		static_assert(!Grid::fixed || Grid::smallestExtent >= 2 * (order / 2) + 1, "Every axis needs at least order + 1 points for this stencil.");
+		return {input, spacing};
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	LazyGradient<Grid, rank, T, Layout, FiniteDifferenceStencil<1, order>, true, Symmetry> lazyGradient_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return lazyGradient_periodicBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	LazyGradient<Grid, rank, T, Layout, FiniteDifferenceStencil<2, order>, false, Symmetry> lazySecondDerivative_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//lazy version of secondDerivative_ignoreBoundary
+		static_assert(!Grid::fixed || Grid::smallestExtent >= 2 * (order / 2) + 1, "Every axis needs at least order + 1 points for this stencil.");
+		return {input, spacing};
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	LazyGradient<Grid, rank, T, Layout, FiniteDifferenceStencil<2, order>, false, Symmetry> lazySecondDerivative_ignoreBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return lazySecondDerivative_ignoreBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	LazyGradient<Grid, rank, T, Layout, FiniteDifferenceStencil<2, order>, true, Symmetry> lazySecondDerivative_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, const std::array<double, Grid::dimensions>& spacing)
+	{
+		//lazy version of secondDerivative_periodicBoundary
+		static_assert(!Grid::fixed || Grid::smallestExtent >= 2 * (order / 2) + 1, "Every axis needs at least order + 1 points for this stencil.");
+		return {input, spacing};
+	}
+
+	template<size_t order = 4, typename Grid, size_t rank, typename T, typename Layout, typename Symmetry>
+	LazyGradient<Grid, rank, T, Layout, FiniteDifferenceStencil<2, order>, true, Symmetry> lazySecondDerivative_periodicBoundary(
+		const GridTensorField<Grid, rank, T, Layout, Symmetry>& input, double dx)
+	{
+		return lazySecondDerivative_periodicBoundary<order>(input, uniformSpacing<Grid::dimensions>(dx));
 	}
 
 }
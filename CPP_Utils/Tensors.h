@@ -15,170 +15,225 @@ namespace SimulationUtilities{
 		template<char ExpressionIdentifier, size_t dimensions, typename... Ts>
 		struct Expression;
 
-		//the single version of Expression.
-		//must be able to handle arbitrary trace (RepeatIs... represents the trace indices),
-		//and non-traced assignments (=, +=, -=, *=)
-		template<size_t rank, size_t dimensions, typename T, typename... FreeIndices, typename... Is, typename... RepeatIs>
-		struct Expression<'s', dimensions, T, IndexPackType<FreeIndices...>, IndexedTensor<rank, dimensions, T, Is...>, IndexPackType<RepeatIs...>>
+		//what is known at compile time about a term or expression at one binding: if known,
+		//value is its value whatever the tensors hold (0 for the zero terms of a Kronecker delta,
+		//+-1 for the non zero ones of a Levi-Civita symbol), otherwise it depends on the data.
+		struct Known_Term
 		{
-			T* data;
-			size_t activeIndexingLocations[rank];
+			bool known;
+			int value;
+		};
 
-			Expression(T* initData)
-			:
-				data(initData)
+		//Known_Value info is what an expression knows about itself at Binding. expressions that
+		//can know something provide a static known<Binding>(), everything else is unknown.
+		template<typename Expr, typename Binding, typename = void>
+		struct Known_Value
+		{
+			static constexpr Known_Term info = {false, 0};
+		};
+
+		template<typename Expr, typename Binding>
+		struct Known_Value<Expr, Binding, std::void_t<decltype(Expr::template known<Binding>())>>
+		{
+			static constexpr Known_Term info = Expr::template known<Binding>();
+		};
+
+		//terms of a sum with nothing known about them
+		struct Unknown_Terms
+		{
+			template<typename Binding>
+			static constexpr Known_Term info()
 			{
-				for (size_t i = 0; i < rank; ++i)
-				{
-					activeIndexingLocations[i] = 0;
-				}
+				return {false, 0};
 			}
+		};
 
-			Expression(const Expression<'s', dimensions, T, IndexPackType<FreeIndices...>,
-				IndexedTensor<rank, dimensions, T, Is...>, IndexPackType<RepeatIs...>>& other)
-			:
-				data(other.data)
+		//Sum_Over_Known evaluates term(binding) for every combination of values of the indices Summed...
+		//bound on top of Binding and adds the results. the loops are unrolled at compile time and
+		//the terms Terms::info<binding>() knows to be zero are left out, so a contraction with a
+		//Kronecker delta or Levi-Civita symbol only adds the terms that can be non zero.
+		//the sum is carried in Template_Accumulator<T>::T.
+		template<size_t dimensions, typename T, typename Binding, typename Terms, typename... Summed>
+		struct Sum_Over_Known
+		{
+			static constexpr Known_Term info = Terms::template info<Binding>();
+			static constexpr bool zero = info.known && info.value == 0;
+			typedef typename Template_Accumulator<T>::T Sum;
+
+			template<typename Term>
+			static inline Sum sum(const Term& term)
 			{
-				for (size_t i = 0; i < rank; ++i)
-				{
-					activeIndexingLocations[i] = other.activeIndexingLocations[i];
-				}
+				return Sum(term(Binding()));
 			}
+		};
 
-			template<typename NextMetaIndex, typename... OtherMetaIs>
-			struct IndexBuilder
+		template<size_t dimensions, typename T, typename Binding, typename Terms, typename Next, typename... Others>
+		struct Sum_Over_Known<dimensions, T, Binding, Terms, Next, Others...>
+		{
+			template<size_t value>
+			using Part = Sum_Over_Known<dimensions, T, typename Template_Bind<Binding, Next, value>::T, Terms, Others...>;
+
+			template<size_t... values>
+			static constexpr Known_Term combine(std::index_sequence<values...>)
 			{
-				static inline void buildIndex(size_t& indexThusFar, const size_t* const& indexingLocations)
-				{
-					constexpr size_t indexPosition = rank - sizeof...(OtherMetaIs) - 1;
-					indexThusFar += indexingLocations[indexPosition];
-					indexThusFar *= dimensions;
-					IndexBuilder<OtherMetaIs...>::buildIndex(indexThusFar, indexingLocations);
-				}
-			};
+				return {(Part<values>::info.known && ...), (0 + ... + Part<values>::info.value)};
+			}
 
-			template<typename LastMetaIndex>
-			struct IndexBuilder<LastMetaIndex>
+			template<size_t... values>
+			static constexpr std::array<bool, dimensions> zeros(std::index_sequence<values...>)
 			{
-				static inline void buildIndex(size_t& indexThusFar, const size_t* const& indexingLocations)
-				{
-					indexThusFar += indexingLocations[rank - 1];
-				}
-			};
+				return {Part<values>::zero...};
+			}
+
+			static constexpr Known_Term info = combine(std::make_index_sequence<dimensions>());
+			static constexpr std::array<bool, dimensions> zeroParts = zeros(std::make_index_sequence<dimensions>());
+			static constexpr bool zero = info.known && info.value == 0;
+			typedef typename Template_Accumulator<T>::T Sum;
 
-			template<typename NextMetaIndex, typename... OtherMetaIs>
-			struct GetValue_Helper
+			//adds the parts from value on to partial (in order, as the plain fold did), skipping zero parts
+			template<size_t value, typename Term>
+			static inline Sum accumulate(Sum partial, const Term& term)
 			{
-				static inline void getValue(T& valueThusFar, T* const& data, size_t* const& activeIndexingLocations)
+				if constexpr (value == dimensions)
 				{
-					static constexpr size_t i0 = Template_Locate_Nth_Key_Type<0, NextMetaIndex, Is...>::value;
-					static constexpr size_t i1 = Template_Locate_Nth_Key_Type<1, NextMetaIndex, Is...>::value;
-					for (size_t i = 0; i < dimensions; ++i)
-					{
-						activeIndexingLocations[i0] = i;
-						activeIndexingLocations[i1] = i;
-						GetValue_Helper<OtherMetaIs...>::getValue(valueThusFar, data, activeIndexingLocations);
-					}
+					return partial;
 				}
-			};
+				else if constexpr (zeroParts[value])
+				{
+					return accumulate<value + 1>(partial, term);
+				}
+				else
+				{
+					return accumulate<value + 1>(partial + Part<value>::sum(term), term);
+				}
+			}
 
-			template<typename LastMetaIndex>
-			struct GetValue_Helper<LastMetaIndex>
+			template<size_t value, typename Term>
+			static inline Sum first(const Term& term)
 			{
-				static inline void getValue(T& valueThusFar, T* const& data, size_t* const& activeIndexingLocations)
+				if constexpr (zeroParts[value])
 				{
-					static constexpr size_t i0 = Template_Locate_Nth_Key_Type<0, LastMetaIndex, Is...>::value;
-					static constexpr size_t i1 = Template_Locate_Nth_Key_Type<1, LastMetaIndex, Is...>::value;
-					for (size_t i = 0; i < dimensions; ++i)
-					{
-						activeIndexingLocations[i0] = i;
-						activeIndexingLocations[i1] = i;
-						size_t index = 0;
-						IndexBuilder<Is...>::buildIndex(index, activeIndexingLocations);
-						valueThusFar += data[index];
-					}
+					return first<value + 1>(term);
 				}
-			};
-
-			//generic expression requirements
+				else
+				{
+					return accumulate<value + 1>(Part<value>::sum(term), term);
+				}
+			}
 
-			inline T getValue()
+			template<typename Term>
+			static inline Sum sum(const Term& term)
 			{
-				if constexpr (sizeof...(RepeatIs) == 0)
+				if constexpr (zero)
 				{
-					if constexpr (sizeof...(Is) == 0)
-					{
-						return data[0];
-					}
-					else
-					{
-						size_t index = 0;
-						IndexBuilder<Is...>::buildIndex(index, activeIndexingLocations);
-						return data[index];
-					}
+					return Sum();
 				}
 				else
 				{
-					T output = T();
-					GetValue_Helper<RepeatIs...>::getValue(output, data, activeIndexingLocations);
-					return output;
+					return first<0>(term);
 				}
 			}
+		};
+
+		//Sum_Over is Sum_Over_Known with nothing known about the terms
+		template<size_t dimensions, typename T, typename Binding, typename... Summed>
+		using Sum_Over = Sum_Over_Known<dimensions, T, Binding, Unknown_Terms, Summed...>;
+
+		//value * input for a value known at compile time
+		template<int value, typename T>
+		inline T knownMultiple(const T& input)
+		{
+			if constexpr (value == 1)
+			{
+				return input;
+			}
+			else if constexpr (value == -1)
+			{
+				return -input;
+			}
+			else
+			{
+				return T(value) * input;
+			}
+		}
+
+		//every expression provides getValue<Binding>(), its value with the free indices
+		//fixed by the compile time IndexBinding Binding.
+
+		//the single version of Expression.
+		//must be able to handle arbitrary trace (RepeatIs... represents the trace indices),
+		//and non-traced assignments (=, +=, -=, *=)
+		template<size_t rank, size_t dimensions, typename T, size_t stride,
+			typename... FreeIndices, typename... Is, typename... RepeatIs>
+		struct Expression<'s', dimensions, T, IndexPackType<FreeIndices...>,
+			IndexedTensor<rank, dimensions, T, stride, Is...>, IndexPackType<RepeatIs...>>
+		{
+			T* data;
+
+			Expression(T* initData)
+			:
+				data(initData)
+			{}
+
+			Expression(const Expression<'s', dimensions, T, IndexPackType<FreeIndices...>,
+				IndexedTensor<rank, dimensions, T, stride, Is...>, IndexPackType<RepeatIs...>>& other)
+			:
+				data(other.data)
+			{}
+
+			//flat position in data of the element picked out by Binding (which must bind all of Is...)
+			template<typename Binding, size_t... positions>
+			static constexpr size_t offset(std::index_sequence<positions...>)
+			{
+				return (0 + ... + (Template_Bound_Value<Is, Binding>::value
+					* Template_Power<dimensions, rank - 1 - positions>::value)) * stride;
+			}
+
+			//generic expression requirements
 
-			template<typename Index>
-			inline void setIndex(const size_t& indexValue)
+			template<typename Binding>
+			inline T getValue() const
 			{
-				if constexpr (Template_Key_In_Pack<Index, Is...>::value)
+				return Sum_Over<dimensions, T, Binding, RepeatIs...>::sum([this](auto binding)
 				{
-					activeIndexingLocations[Template_Locate_Key_Type<Index, Is...>::value] = indexValue;
-				}
+					return data[offset<decltype(binding)>(std::index_sequence_for<Is...>())];
+				});
 			}
 
 			//single expression requirements. needs to handle = operator and similar things
 
-			typedef Expression<'s', dimensions, T, IndexPackType<FreeIndices...>, IndexedTensor<rank, dimensions, T, Is...>, IndexPackType<RepeatIs...>> SelfType;
+			typedef Expression<'s', dimensions, T, IndexPackType<FreeIndices...>,
+				IndexedTensor<rank, dimensions, T, stride, Is...>, IndexPackType<RepeatIs...>> SelfType;
+
+			//each element of this tensor gets its own statement, with the indices of the other side
+			//fixed at compile time to the values Is... take at that element
 
-			template<typename NextMetaIndex, typename... OtherMetaIs>
-			struct Equal_Helper
+			template<typename Other, size_t... elements>
+			inline void setEqual(const Other& other, std::index_sequence<elements...>)
 			{
-				template<char ID, typename... OtherIs>
-				static inline void setEqual(T* const& data, Expression<ID, dimensions, T, OtherIs...>& other, size_t index)
-				{
-					constexpr size_t incr = Template_Power<dimensions, sizeof...(OtherMetaIs)>::value;
-					for (size_t i = 0; i < dimensions; ++i)
-					{
-						other.template setIndex<NextMetaIndex>(i);
-						Equal_Helper<OtherMetaIs...>::setEqual(data, other, index + i * incr);
-					}
-				}
-			};
+				(void(data[elements * stride] =
+					other.template getValue<typename Template_Element_Binding<dimensions, elements, Is...>::T>()), ...);
+			}
 
-			template<typename LastMetaIndex>
-			struct Equal_Helper<LastMetaIndex>
+			template<typename Other, size_t... elements>
+			inline void add(const Other& other, std::index_sequence<elements...>)
 			{
-				template<char ID, typename... OtherIs>
-				static inline void setEqual(T* const& data, Expression<ID, dimensions, T, OtherIs...>& other, size_t index)
-				{
-					for (size_t i = 0; i < dimensions; ++i)
-					{
-						other.template setIndex<LastMetaIndex>(i);
-						data[index + i] = other.getValue();
-					}
-				}
-			};
+				(void(data[elements * stride] +=
+					other.template getValue<typename Template_Element_Binding<dimensions, elements, Is...>::T>()), ...);
+			}
+
+			template<typename Other, size_t... elements>
+			inline void subtract(const Other& other, std::index_sequence<elements...>)
+			{
+				(void(data[elements * stride] -=
+					other.template getValue<typename Template_Element_Binding<dimensions, elements, Is...>::T>()), ...);
+			}
 
 			template<char ID, typename... OtherIs>
 			SelfType& operator=(Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, OtherIs...>&& other)
 			{
 				static_assert(sizeof...(RepeatIs) == 0);
-				if constexpr (sizeof...(Is) == 0)
-				{
-					data[0] = other.getValue();
-				}
-				else
-				{
-					Equal_Helper<Is...>::setEqual(data, other, 0);
-				}
+				setEqual(other, std::make_index_sequence<Template_Power<dimensions, rank>::value>());
 				return *this;
 			}
 
@@ -186,96 +241,24 @@ namespace SimulationUtilities{
 			{
 				for (size_t i = 0; i < Template_Power<dimensions, rank>::value; ++i)
 				{
-					data[i] = other.data[i];
+					data[i * stride] = other.data[i * stride];
 				}
 				return *this;
 			}
 
-			template<typename NextMetaIndex, typename... OtherMetaIs>
-			struct Plus_Helper
-			{
-				template<char ID, typename... OtherIs>
-				static inline void add(T* const& data, Expression<ID, dimensions, T, OtherIs...>& other, size_t index)
-				{
-					constexpr size_t incr = Template_Power<dimensions, sizeof...(OtherMetaIs)>::value;
-					for (size_t i = 0; i < dimensions; ++i)
-					{
-						other.template setIndex<NextMetaIndex>(i);
-						Plus_Helper<OtherMetaIs...>::add(data, other, index + i * incr);
-					}
-				}
-			};
-
-			template<typename LastMetaIndex>
-			struct Plus_Helper<LastMetaIndex>
-			{
-				template<char ID, typename... OtherIs>
-				static inline void add(T* const& data, Expression<ID, dimensions, T, OtherIs...>& other, size_t index)
-				{
-					for (size_t i = 0; i < dimensions; ++i)
-					{
-						other.template setIndex<LastMetaIndex>(i);
-						data[index + i] += other.getValue();
-					}
-				}
-			};
-
 			template<char ID, typename... OtherIs>
 			SelfType& operator+=(Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, OtherIs...>&& other)
 			{
 				static_assert(sizeof...(RepeatIs) == 0);
-				if constexpr (sizeof...(Is) == 0)
-				{
-					data[0] += other.getValue();
-				}
-				else
-				{
-					Plus_Helper<Is...>::add(data, other, 0);
-				}
+				add(other, std::make_index_sequence<Template_Power<dimensions, rank>::value>());
 				return *this;
 			}
 
-			template<typename NextMetaIndex, typename... OtherMetaIs>
-			struct Minus_Helper
-			{
-				template<char ID, typename... OtherIs>
-				static inline void subtract(T* const& data, Expression<ID, dimensions, T, OtherIs...>& other, size_t index)
-				{
-					constexpr size_t incr = Template_Power<dimensions, sizeof...(OtherMetaIs)>::value;
-					for (size_t i = 0; i < dimensions; ++i)
-					{
-						other.template setIndex<NextMetaIndex>(i);
-						Minus_Helper<OtherMetaIs...>::subtract(data, other, index + i * incr);
-					}
-				}
-			};
-
-			template<typename LastMetaIndex>
-			struct Minus_Helper<LastMetaIndex>
-			{
-				template<char ID, typename... OtherIs>
-				static inline void subtract(T* const& data, Expression<ID, dimensions, T, OtherIs...>& other, size_t index)
-				{
-					for (size_t i = 0; i < dimensions; ++i)
-					{
-						other.template setIndex<LastMetaIndex>(i);
-						data[index + i] -= other.getValue();
-					}
-				}
-			};
-
 			template<char ID, typename... OtherIs>
 			SelfType& operator-=(Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, OtherIs...>&& other)
 			{
 				static_assert(sizeof...(RepeatIs) == 0);
-				if constexpr (sizeof...(Is) == 0)
-				{
-					data[0] -= other.getValue();
-				}
-				else
-				{
-					Minus_Helper<Is...>::subtract(data, other, 0);
-				}
+				subtract(other, std::make_index_sequence<Template_Power<dimensions, rank>::value>());
 				return *this;
 			}
 		};
@@ -290,71 +273,64 @@ namespace SimulationUtilities{
 			Expression<ID1, dimensions, T, Is1...> val1;
 			Expression<ID2, dimensions, T, Is2...> val2;
 
-			template<typename NextMetaIndex, typename... OtherMetaIs>
-			struct GetValue_Helper
+			//a product term is known when both factors are, or zero when either is
+			struct Terms
 			{
-				static inline void getValue(T& valueThusFar, Expression<ID1, dimensions, T, Is1...>& val1,
-					Expression<ID2, dimensions, T, Is2...>& val2)
+				template<typename Bound>
+				static constexpr Known_Term info()
 				{
-					for (size_t i = 0; i < dimensions; ++i)
+					constexpr Known_Term info1 = Known_Value<Expression<ID1, dimensions, T, Is1...>, Bound>::info;
+					constexpr Known_Term info2 = Known_Value<Expression<ID2, dimensions, T, Is2...>, Bound>::info;
+					if (Inverter::value)
 					{
-						val1.template setIndex<NextMetaIndex>(i);
-						val2.template setIndex<NextMetaIndex>(i);
-						GetValue_Helper<OtherMetaIs...>::getValue(valueThusFar, val1, val2);
+						return {false, 0};
 					}
-				}
-			};
-
-			template<typename LastMetaIndex>
-			struct GetValue_Helper<LastMetaIndex>
-			{
-				static inline void getValue(T& valueThusFar, Expression<ID1, dimensions, T, Is1...>& val1,
-					Expression<ID2, dimensions, T, Is2...>& val2)
-				{
-					for (size_t i = 0; i < dimensions; ++i)
+					if ((info1.known && info1.value == 0) || (info2.known && info2.value == 0))
 					{
-						val1.template setIndex<LastMetaIndex>(i);
-						val2.template setIndex<LastMetaIndex>(i);
-						if constexpr (Inverter::value)
-						{
-							valueThusFar += val1.getValue() / val2.getValue();
-						}
-						else
-						{
-							valueThusFar += val1.getValue() * val2.getValue();
-						}
+						return {true, 0};
 					}
+					return {info1.known && info2.known, info1.value * info2.value};
 				}
 			};
 
+			template<typename Binding>
+			static constexpr Known_Term known()
+			{
+				return Sum_Over_Known<dimensions, T, Binding, Terms, ContractionIndices...>::info;
+			}
+
 			//generic expression requirements
 
-			inline T getValue()
+			template<typename Binding>
+			inline T getValue() const
 			{
-				if constexpr (sizeof...(ContractionIndices) == 0)
+				return Sum_Over_Known<dimensions, T, Binding, Terms, ContractionIndices...>::sum([this](auto binding)
 				{
+					typedef decltype(binding) Bound;
+					constexpr Known_Term info1 = Known_Value<Expression<ID1, dimensions, T, Is1...>, Bound>::info;
+					constexpr Known_Term info2 = Known_Value<Expression<ID2, dimensions, T, Is2...>, Bound>::info;
+					typedef typename Template_Accumulator<T>::T Sum;
 					if constexpr (Inverter::value)
 					{
-						return val1.getValue() / val2.getValue();
+						return Sum(val1.template getValue<Bound>()) / Sum(val2.template getValue<Bound>());
+					}
+					else if constexpr (info1.known && info2.known)
+					{
+						return T(info1.value * info2.value);
+					}
+					else if constexpr (info1.known)
+					{
+						return knownMultiple<info1.value>(val2.template getValue<Bound>());
+					}
+					else if constexpr (info2.known)
+					{
+						return knownMultiple<info2.value>(val1.template getValue<Bound>());
 					}
 					else
 					{
-						return val1.getValue() * val2.getValue();
+						return Sum(val1.template getValue<Bound>()) * Sum(val2.template getValue<Bound>());
 					}
-				}
-				else
-				{
-					T output;
-					GetValue_Helper<ContractionIndices...>::getValue(output, val1, val2);
-					return output;
-				}
-			}
-
-			template<typename Index>
-			inline void setIndex(const size_t& indexValue)
-			{
-				val1.template setIndex<Index>(indexValue);
-				val2.template setIndex<Index>(indexValue);
+				});
 			}
 		};
 
@@ -367,26 +343,28 @@ namespace SimulationUtilities{
 			Expression<ID1, dimensions, T, Is1...> val1;
 			Expression<ID2, dimensions, T, Is2...> val2;
 
+			template<typename Binding>
+			static constexpr Known_Term known()
+			{
+				constexpr Known_Term info1 = Known_Value<Expression<ID1, dimensions, T, Is1...>, Binding>::info;
+				constexpr Known_Term info2 = Known_Value<Expression<ID2, dimensions, T, Is2...>, Binding>::info;
+				return {info1.known && info2.known, Inverter::value ? info1.value - info2.value : info1.value + info2.value};
+			}
+
 			//generic expression requirements
 
-			inline T getValue()
+			template<typename Binding>
+			inline T getValue() const
 			{
 				if constexpr (Inverter::value)
 				{
-					return val1.getValue() - val2.getValue();
+					return val1.template getValue<Binding>() - val2.template getValue<Binding>();
 				}
 				else
 				{
-					return val1.getValue() + val2.getValue();
+					return val1.template getValue<Binding>() + val2.template getValue<Binding>();
 				}
 			}
-
-			template<typename Index>
-			inline void setIndex(const size_t& indexValue)
-			{
-				val1.template setIndex<Index>(indexValue);
-				val2.template setIndex<Index>(indexValue);
-			}
 		};
 
 		//expression for scalar multiplication
@@ -397,25 +375,28 @@ namespace SimulationUtilities{
 			T multiplier;
 			Expression<ID, dimensions, T, Is...> val;
 
+			//zero stays zero, anything else depends on the multiplier
+			template<typename Binding>
+			static constexpr Known_Term known()
+			{
+				constexpr Known_Term info = Known_Value<Expression<ID, dimensions, T, Is...>, Binding>::info;
+				return {info.known && info.value == 0, 0};
+			}
+
 			//generic expression requirements
 
-			inline T getValue()
+			template<typename Binding>
+			inline T getValue() const
 			{
 				if constexpr (Inverter::value)
 				{
-					return val.getValue() / multiplier;
+					return val.template getValue<Binding>() / multiplier;
 				}
 				else
 				{
-					return multiplier * val.getValue();
+					return multiplier * val.template getValue<Binding>();
 				}
 			}
-
-			template<typename Index>
-			inline void setIndex(const size_t& indexValue)
-			{
-				val.template setIndex<Index>(indexValue);
-			}
 		};
 
 		//template dependencies
@@ -484,7 +465,7 @@ namespace SimulationUtilities{
 		Expression<'m', dimensions, T, IndexPackType<FreeIndices...>,
 			Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, Is...>, InverseType<false>>
 		//operation
-		operator*(T left, Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, Is...> right)
+		operator*(typename Template_Identity<T>::T left, Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, Is...> right)
 		{
 			return {left, right};
 		}
@@ -495,7 +476,7 @@ namespace SimulationUtilities{
 		Expression<'m', dimensions, T, IndexPackType<FreeIndices...>,
 			Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, Is...>, InverseType<false>>
 		//operation
-		operator*(Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, Is...> left, T right)
+		operator*(Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, Is...> left, typename Template_Identity<T>::T right)
 		{
 			return {right, left};
 		}
@@ -506,7 +487,7 @@ namespace SimulationUtilities{
 		Expression<'m', dimensions, T, IndexPackType<FreeIndices...>,
 			Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, Is...>, InverseType<true>>
 		//operation
-		operator/(Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, Is...> left, T right)
+		operator/(Expression<ID, dimensions, T, IndexPackType<FreeIndices...>, Is...> left, typename Template_Identity<T>::T right)
 		{
 			return {right, left};
 		}
@@ -548,63 +529,68 @@ namespace SimulationUtilities{
 		{
 			return Expression<'s', dimensions, T,
 				typename Template_Remove_Repeats<IndexIdentifiers...>::T,
-				IndexedTensor<rank, dimensions, T, IndexIdentifiers...>,
+				IndexedTensor<rank, dimensions, T, 1, IndexIdentifiers...>,
 				typename Template_Get_Repeats<IndexIdentifiers...>::T>((T*)data);
 		}
 
-		template<typename S, typename = std::enable_if_t<!std::is_same<T, double>::value && std::is_same<T, S>::value>>
-		SelfType& operator*=(S other)
+		//floating point tensors scale in their own precision (a float tensor at float SIMD width)
+		SelfType& operator*=(double other)
 		{
-			for (size_t i = 0; i < Template_Power<dimensions, rank>::value; ++i)
+			if constexpr (std::is_floating_point<T>::value)
 			{
-				data[i] *= other;
+				simdApply<SimdMultiply>(data, T(other), Template_Power<dimensions, rank>::value);
+			}
+			else
+			{
+				for (size_t i = 0; i < Template_Power<dimensions, rank>::value; ++i)
+				{
+					data[i] *= other;
+				}
 			}
 			return *this;
 		}
 
-		template<typename S, typename = std::enable_if_t<!std::is_same<T, double>::value && std::is_same<T, S>::value>>
-		SelfType& operator/=(S other)
+		SelfType& operator/=(double other)
 		{
-			for (size_t i = 0; i < Template_Power<dimensions, rank>::value; ++i)
+			if constexpr (std::is_floating_point<T>::value)
 			{
-				data[i] /= other;
+				simdApply<SimdDivide>(data, T(other), Template_Power<dimensions, rank>::value);
+			}
+			else
+			{
+				for (size_t i = 0; i < Template_Power<dimensions, rank>::value; ++i)
+				{
+					data[i] /= other;
+				}
 			}
 			return *this;
 		}
 
-		SelfType& operator*=(double other)
+		//scaling by the tensor's own scalar type, for other types such as std::complex<double>
+		//(float tensors given a float take the same SIMD path)
+		template<typename S, typename = std::enable_if_t<!std::is_same<T, double>::value && std::is_same<T, S>::value>>
+		SelfType& operator*=(S other)
 		{
-			for (size_t i = 0; i < Template_Power<dimensions, rank>::value; ++i)
-			{
-				data[i] *= other;
-			}
+			simdApply<SimdMultiply>(data, other, Template_Power<dimensions, rank>::value);
 			return *this;
 		}
 
-		SelfType& operator/=(double other)
+		template<typename S, typename = std::enable_if_t<!std::is_same<T, double>::value && std::is_same<T, S>::value>>
+		SelfType& operator/=(S other)
 		{
-			for (size_t i = 0; i < Template_Power<dimensions, rank>::value; ++i)
-			{
-				data[i] /= other;
-			}
+			simdApply<SimdDivide>(data, other, Template_Power<dimensions, rank>::value);
 			return *this;
 		}
 
 		SelfType& operator+=(const SelfType& other)
 		{
-			for (size_t i = 0; i < Template_Power<dimensions, rank>::value; ++i)
-			{
-				data[i] += other.data[i];
-			}
+			simdApply<SimdAdd>(data, (const T*)other.data, Template_Power<dimensions, rank>::value);
 			return *this;
 		}
 
 		SelfType& operator-=(const SelfType& other)
 		{
-			for (size_t i = 0; i < Template_Power<dimensions, rank>::value; ++i)
-			{
-				data[i] -= other.data[i];
-			}
+			simdApply<SimdSubtract>(data, (const T*)other.data, Template_Power<dimensions, rank>::value);
 			return *this;
 		}
 
@@ -710,24 +696,6 @@ namespace SimulationUtilities{
 		return left -= right;
 	}
 
-	template<size_t dimensions, size_t rank, typename T, std::enable_if_t<!std::is_same<T, double>::value>>
-	Tensor<dimensions, rank, T> operator*(Tensor<dimensions, rank, T> left, const T& right)
-	{
-		return left *= right;
-	}
-
-	template<size_t dimensions, size_t rank, typename T, std::enable_if_t<!std::is_same<T, double>::value>>
-	Tensor<dimensions, rank, T> operator*(const T& left, Tensor<dimensions, rank, T> right)
-	{
-		return right *= left;
-	}
-
-	template<size_t dimensions, size_t rank, typename T, std::enable_if_t<!std::is_same<T, double>::value>>
-	Tensor<dimensions, rank, T> operator/(Tensor<dimensions, rank, T> left, const T& right)
-	{
-		return left /= right;
-	}
-
 	template<size_t dimensions, size_t rank, typename T>
 	Tensor<dimensions, rank, T> operator*(Tensor<dimensions, rank, T> left, const double& right)
 	{
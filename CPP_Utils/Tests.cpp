@@ -0,0 +1,885 @@
+//behaviour checks for the field, stencil and state utilities.
+//
+//build and run (from this directory):
+//	g++ -std=c++17 -O2 -march=native -pthread Tests.cpp -o tests
+//	./tests
+//
+//every failed check is printed, the exit status is the number of failed checks.
+
+#include "VectorSpace.h"
+
+#include <complex>
+
+using namespace SimulationUtilities;
+
+namespace
+{
+	size_t failures = 0;
+
+	void check(bool passed, const std::string& name)
+	{
+		if (!passed)
+		{
+			std::cerr << "FAILED: " << name << std::endl;
+			++failures;
+		}
+	}
+
+	void checkClose(double value, double expected, double tolerance, const std::string& name)
+	{
+		if (!(std::abs(value - expected) <= tolerance))
+		{
+			std::cerr << "FAILED: " << name << " (" << value << ", expected " << expected << ")" << std::endl;
+			++failures;
+		}
+	}
+
+	//true if body throws std::invalid_argument
+	template<typename Body>
+	bool rejects(const Body& body)
+	{
+		try
+		{
+			body();
+		}
+		catch (const std::invalid_argument&)
+		{
+			return true;
+		}
+		return false;
+	}
+
+	//run time grids: stencils on too small a grid and mismatched linear combinations are refused
+	void dynamicGrids()
+	{
+		DynamicTensorField<2, 0> small(DynamicExtents<2>({3, 3}));
+		check(rejects([&]{gradient_ignoreBoundary(small, 0.1);}), "gradient on a 3x3 grid is rejected");
+		check(rejects([&]{gradient_periodicBoundary<2>(DynamicTensorField<2, 0>(DynamicExtents<2>({8, 2})), 0.1);}),
+			"second order gradient on an 8x2 grid is rejected");
+		check(rejects([&]{lazyGradient_ignoreBoundary(small, 0.1);}), "lazy gradient on a 3x3 grid is rejected");
+		check(!rejects([&]{gradient_ignoreBoundary<2>(small, 0.1);}), "second order gradient on a 3x3 grid is allowed");
+
+		DynamicTensorField<2, 1> a(DynamicExtents<2>({6, 8})), b(DynamicExtents<2>({8, 6})), output;
+		check(rejects([&]{linearCombination(output, {1, 1}, {&a, &b});}), "linearCombination of different grids is rejected");
+
+		b = DynamicTensorField<2, 1>(DynamicExtents<2>({6, 8}));
+		std::fill(a.getData(), a.getData() + 96, 1.0);
+		std::fill(b.getData(), b.getData() + 96, 2.0);
+		linearCombination(output, {2, 3}, {&a, &b});
+		check(output.size() == 48 && output.getGrid().extents[1] == 8, "linearCombination sizes the output");
+		checkClose(output.getData()[17], 8, 0, "linearCombination value");
+
+		DynamicTensorField<2, 1> large(DynamicExtents<2>({100, 100})), square(DynamicExtents<2>({4, 4}));
+		check(rejects([&]{large += square;}), "adding a field on another grid is rejected");
+		check(rejects([&]{large -= square;}), "subtracting a field on another grid is rejected");
+		Index<'i'> i;
+		check(rejects([&]{large(i) = square(i) * 2.0;}), "assigning an expression on another grid is rejected");
+		check(rejects([&]{large(i) += a(i) + square(i);}), "an expression mixing grids is rejected");
+		check(!rejects([&]{a(i) = b(i) * 2.0;}), "expressions on the same grid are allowed");
+		check(rejects([&]{advect_periodicBoundary(square, large, 0.1);}), "advection with a velocity on another grid is rejected");
+		check(!rejects([&]{advect_periodicBoundary(large, large, 0.1);}), "advection on one grid is allowed");
+	}
+
+	//value of a ghosted 2d field at interior position (i, j), negative or past the end for ghost cells
+	template<size_t rank, size_t ghosts>
+	double ghostedValue(const GhostedTensorField<2, rank, double, ghosts>& field, long i, long j, size_t component = 0)
+	{
+		const DynamicExtents<2>& grid = field.local().getGrid();
+		size_t point = size_t(i + long(ghosts)) * grid.stride(0) + size_t(j + long(ghosts));
+		return field.local().getData()[point * Template_Power<2, rank>::value + component];
+	}
+
+	//fills the interior with f(i, j) + component
+	template<size_t rank, size_t ghosts, typename Function>
+	void setGhostedInterior(GhostedTensorField<2, rank, double, ghosts>& field, const Function& f)
+	{
+		const std::array<size_t, 2>& extents = field.getInteriorExtents();
+		for (size_t i = 0; i < extents[0]; ++i)
+		{
+			for (size_t j = 0; j < extents[1]; ++j)
+			{
+				for (size_t c = 0; c < Template_Power<2, rank>::value; ++c)
+				{
+					field.local().getData()[field.paddedPoint({i, j}) * Template_Power<2, rank>::value + c] = f(i, j) + double(c);
+				}
+			}
+		}
+	}
+
+	//ghost cells of every boundary condition, on both sides and in the corners
+	void ghostBoundaries()
+	{
+		auto f = [](size_t i, size_t j){return double(10 * i + j * j);};
+		GhostedTensorField<2, 0, double, 2> scalar({6, 7});
+		setGhostedInterior(scalar, f);
+
+		scalar.fillGhosts();
+		bool periodic = true;
+		for (long i = -2; i < 8; ++i)
+		{
+			for (long j = -2; j < 9; ++j)
+			{
+				periodic &= ghostedValue(scalar, i, j) == f(size_t(i + 6) % 6, size_t(j + 7) % 7);
+			}
+		}
+		check(periodic, "periodic ghosts, corners included");
+
+		scalar.setBoundary(0, 0, GhostBoundary<>::dirichlet(1.5));
+		scalar.setBoundary(0, 1, GhostBoundary<>::neumann(0.25));
+		scalar.setBoundary(1, 0, GhostBoundary<>::neumann());
+		scalar.setBoundary(1, 1, GhostBoundary<>::dirichlet(-1));
+		scalar.fillGhosts();
+		bool mirrored = true;
+		for (long d = 1; d <= 2; ++d)
+		{
+			for (long k = 0; k < 6; ++k)
+			{
+				mirrored &= ghostedValue(scalar, -d, k) == 3 - ghostedValue(scalar, d, k);
+				mirrored &= ghostedValue(scalar, 5 + d, k) == ghostedValue(scalar, 5 - d, k) + 0.5 * double(d);
+				mirrored &= ghostedValue(scalar, k, -d) == ghostedValue(scalar, k, d);
+				mirrored &= ghostedValue(scalar, k, 6 + d) == -2 - ghostedValue(scalar, k, 6 - d);
+			}
+		}
+		check(mirrored, "dirichlet and neumann ghosts");
+		checkClose(ghostedValue(scalar, -1, -2), 3 - ghostedValue(scalar, 1, -2), 0, "corner ghosts follow the later axis fill");
+		checkClose(ghostedValue(scalar, -1, -2), 3 - f(1, 2), 0, "corner ghost value");
+
+		scalar.setBoundary(0, 0, GhostBoundary<>::dirichlet(1.5).atFace());
+		scalar.setBoundary(0, 1, GhostBoundary<>::neumann(0.25).atFace());
+		scalar.setBoundary(1, 0, GhostBoundary<>::external());
+		scalar.setBoundary(1, 1, GhostBoundary<>::external());
+		double kept = ghostedValue(scalar, 3, -1);
+		scalar.fillGhosts();
+		bool faces = true;
+		for (long d = 1; d <= 2; ++d)
+		{
+			for (long k = 0; k < 7; ++k)
+			{
+				faces &= ghostedValue(scalar, -d, k) == 3 - ghostedValue(scalar, d - 1, k);
+				faces &= ghostedValue(scalar, 5 + d, k) == ghostedValue(scalar, 6 - d, k) + 0.25 * double(2 * d - 1);
+			}
+		}
+		check(faces, "face centred dirichlet and neumann ghosts");
+		checkClose(ghostedValue(scalar, 3, -1), kept, 0, "external ghosts are left alone");
+
+		GhostedTensorField<2, 1, double, 2> vector({5, 5});
+		setGhostedInterior(vector, f);
+		vector.setBoundary(GhostBoundary<>::reflective());
+		vector.fillGhosts();
+		checkClose(ghostedValue(vector, -2, 3, 0), -ghostedValue(vector, 2, 3, 0), 0, "reflective flips the normal component");
+		checkClose(ghostedValue(vector, -2, 3, 1), ghostedValue(vector, 2, 3, 1), 0, "reflective keeps the tangential component");
+		checkClose(ghostedValue(vector, 1, 5, 1), -ghostedValue(vector, 1, 3, 1), 0, "reflective along the second axis");
+
+		GhostedTensorField<2, 0, double, 2> thin({1, 6});
+		check(rejects([&]{thin.fillGhosts();}), "periodic ghosts need ghosts interior points");
+		GhostedTensorField<2, 0, double, 2> narrow({2, 6});
+		narrow.fillGhosts();
+		narrow.setBoundary(0, 1, GhostBoundary<>::dirichlet(0));
+		check(rejects([&]{narrow.fillGhosts();}), "mirrored ghosts need ghosts + 1 interior points");
+		narrow.setBoundary(0, 1, GhostBoundary<>::dirichlet(0).atFace());
+		check(!rejects([&]{narrow.fillGhosts();}), "face centred ghosts need ghosts interior points");
+	}
+
+	//value of component c at position of a field with components values per point
+	template<typename Layout, typename Field>
+	double valueAt(const Field& field, size_t components, const std::array<size_t, 3>& position, size_t c)
+	{
+		size_t point = field.getGrid().index(position);
+		return field.getData()[point * Layout::pointStride(components) + c * Layout::componentStride(field.size())];
+	}
+
+	//gradients on tiled and Morton ordered grids (and their lazy gradients) match the row major ones
+	template<typename Grid, typename Layout>
+	bool matchesRowMajor()
+	{
+		constexpr size_t n = 16;
+		GridTensorField<Extents<n, n, n>, 1> rowMajor;
+		GridTensorField<Grid, 1, double, Layout> ordered;
+		for (size_t x = 0; x < n * n * n; ++x)
+		{
+			std::array<size_t, 3> position = {x / (n * n), x / n % n, x % n};
+			for (size_t c = 0; c < 3; ++c)
+			{
+				double value = std::sin(0.3 * double(position[0]) + double(c)) * std::cos(0.2 * double(position[1] * position[2]));
+				rowMajor.getData()[x * 3 + c] = value;
+				ordered.getData()[ordered.getGrid().index(position) * Layout::pointStride(3) + c * Layout::componentStride(n * n * n)] = value;
+			}
+		}
+		auto expected = gradient_ignoreBoundary(rowMajor, 0.1);
+		auto expectedPeriodic = gradient_periodicBoundary(rowMajor, 0.1);
+		auto output = gradient_ignoreBoundary(ordered, 0.1);
+		auto periodic = gradient_periodicBoundary(ordered, 0.1);
+		decltype(output) lazy;
+		Index<'i'> i;
+		Index<'j'> j;
+		lazy(i, j) = lazyGradient_ignoreBoundary(ordered, 0.1)(i, j);
+
+		bool same = true;
+		for (size_t x = 0; x < n * n * n; ++x)
+		{
+			std::array<size_t, 3> position = {x / (n * n), x / n % n, x % n};
+			for (size_t c = 0; c < 9; ++c)
+			{
+				double value = expected.getData()[x * 9 + c];
+				double periodicValue = expectedPeriodic.getData()[x * 9 + c];
+				same &= std::abs(valueAt<Layout>(output, 9, position, c) - value) <= 1e-12 * (1 + std::abs(value))
+					&& std::abs(valueAt<Layout>(lazy, 9, position, c) - value) <= 1e-12 * (1 + std::abs(value))
+					&& std::abs(valueAt<Layout>(periodic, 9, position, c) - periodicValue) <= 1e-12 * (1 + std::abs(periodicValue));
+			}
+		}
+		return same;
+	}
+
+	void orderedGrids()
+	{
+		for (size_t threads : {1, 3})
+		{
+			setParallelExecution(threads);
+			check(matchesRowMajor<TiledExtents<4, 16, 16, 16>, PointMajor>(), "gradients on a tiled grid");
+			check(matchesRowMajor<TiledExtents<8, 16, 16, 16>, ComponentMajor>(), "component major gradients on a tiled grid");
+			check(matchesRowMajor<MortonExtents<16, 16, 16>, PointMajor>(), "gradients on a Morton grid");
+		}
+		setParallelExecution(1);
+	}
+
+	//largest difference between the first count scalars of two fields
+	template<typename Left, typename Right>
+	double largestDifference(const Left& left, const Right& right, size_t count)
+	{
+		double output = 0;
+		for (size_t n = 0; n < count; ++n)
+		{
+			output = std::max(output, std::abs(left.getData()[n] - right.getData()[n]));
+		}
+		return output;
+	}
+
+	//the fused operators agree with contractions of the full derivative fields
+	template<typename Grid>
+	void operatorsMatchDerivatives(const std::string& name)
+	{
+		constexpr size_t points = Grid::points;
+		Index<'i'> i;
+		Index<'j'> j;
+		Index<'k'> k;
+		Index<'l'> l;
+		GridTensorField<Grid, 1> v;
+		GridTensorField<Grid, 3, double, PointMajor, Symmetric<>> m;
+		for (size_t n = 0; n < points * 3; ++n)
+		{
+			v.getData()[n] = std::sin(0.37 * double(n));
+		}
+		for (size_t n = 0; n < points * 10; ++n)
+		{
+			m.getData()[n] = std::cos(0.05 * double(n) + 1);
+		}
+		double h = 0.1;
+
+		auto g = gradient_periodicBoundary(v, h);
+		GridTensorField<Grid, 0> divergence;
+		divergence() = g(i, i);
+		GridTensorField<Grid, 1> curl;
+		curl(i) = LeviCivita<3>()(i, j, k) * g(j, k);
+		auto second = secondDerivative_ignoreBoundary(v, h);
+		GridTensorField<Grid, 1> laplacian;
+		laplacian(j) = second(i, j) * Tensor<3, 1>(std::vector<double>{1, 1, 1})(i);
+		auto gm = gradient_ignoreBoundary(m, h);
+		GridTensorField<Grid, 2, double, PointMajor, Symmetric<>> packedDivergence;
+		packedDivergence(k, l) = gm(i, i, k, l);
+		GridTensorField<Grid, 3, double, PointMajor, Symmetric<>> advected;
+		advected(j, k, l) = v(i) * gm(i, j, k, l);
+
+		auto fusedDivergence = divergence_periodicBoundary(v, h);
+		auto fusedPacked = divergence_ignoreBoundary(m, h);
+		static_assert(std::is_same<decltype(fusedPacked), decltype(packedDivergence)>::value,
+			"divergence keeps the symmetry of the other indices");
+		check(largestDifference(fusedDivergence, divergence, points) < 1e-12, name + " divergence");
+		check(largestDifference(curl_periodicBoundary(v, h), curl, points * 3) < 1e-12, name + " curl");
+		check(largestDifference(laplacian_ignoreBoundary(v, h), laplacian, points * 3) < 1e-10, name + " laplacian");
+		check(largestDifference(fusedPacked, packedDivergence, points * 6) < 1e-12, name + " divergence of a packed field");
+		check(largestDifference(advect_ignoreBoundary(v, m, h), advected, points * 10) < 1e-12, name + " advection of a packed field");
+	}
+
+	void differentialOperators()
+	{
+		for (size_t threads : {1, 3})
+		{
+			setParallelExecution(threads);
+			operatorsMatchDerivatives<Extents<10, 11, 12>>("row major");
+			operatorsMatchDerivatives<MortonExtents<16, 16, 16>>("Morton");
+		}
+		setParallelExecution(1);
+
+		//once warmed up, the fused operators take their output and scratch buffers from the pool
+		GridTensorField<Extents<10, 11, 12>, 1, double> rowMajor;
+		GridTensorField<MortonExtents<16, 16, 16>, 1, double> morton;
+		laplacian_periodicBoundary(rowMajor, 0.1);
+		divergence_periodicBoundary(morton, 0.1);
+		currentBufferPool()->resetStatistics();
+		laplacian_periodicBoundary(rowMajor, 0.1);
+		divergence_periodicBoundary(morton, 0.1);
+		//(each buffer and its shared_ptr control block is one hit)
+		BufferPoolStatistics statistics = bufferPoolStatistics();
+		check(statistics.misses == 0 && statistics.hits == 8, "fused operators do not allocate in steady state");
+	}
+
+	//reductions give the same bits for every thread count and schedule
+	void reproducibleReductions()
+	{
+		TensorField<3, 1, 24> field;
+		double* data = field.getData();
+		for (size_t i = 0; i < field.size() * 3; ++i)
+		{
+			data[i] = std::sin(0.37 * double(i)) * std::pow(10.0, double(i % 13) - 6);
+		}
+		setParallelExecution(1);
+		double sum = sumOf(field), dot = dotProduct(field, field), largest = normLInf(field);
+		bool same = true;
+		for (size_t threads : {2, 3, 7})
+		{
+			for (Schedule schedule : {Schedule::Static, Schedule::Dynamic})
+			{
+				setParallelExecution(threads, schedule, 1000);
+				same &= sumOf(field) == sum && dotProduct(field, field) == dot && normLInf(field) == largest;
+			}
+		}
+		setParallelExecution(1);
+		check(same, "field reductions do not depend on the thread count");
+
+		double naive = 0;
+		for (size_t i = 0; i < field.size() * 3; ++i)
+		{
+			naive += data[i];
+		}
+		checkClose(sum, naive, 1e-9 * std::abs(naive), "field sum");
+
+		Tensor<3, 2> a, b;
+		for (size_t i = 0; i < 9; ++i)
+		{
+			a.getData()[i] = double(i) + 0.5;
+			b.getData()[i] = 2 - double(i);
+		}
+		DirectSum<Tensor<3, 2>, double> left(a, 2.0), right(b, 3.0);
+		double expected = 6;
+		for (size_t i = 0; i < 9; ++i)
+		{
+			expected += a.getData()[i] * b.getData()[i];
+		}
+		checkClose(dotProduct(left, right), expected, 1e-12, "DirectSum dot product");
+		checkClose(left.dotProduct(right), expected, 1e-12, "DirectSum member dot product");
+		checkClose(maximumOf(a), 8.5, 0, "tensor maximum");
+
+		DynamicTensorField<2, 1> large(DynamicExtents<2>({100, 100})), square(DynamicExtents<2>({4, 4}));
+		check(rejects([&]{dotProduct(large, square);}), "a dot product of fields on different grids is rejected");
+		check(rejects([&]{weightedRmsNorm(large, square, 1e-8, 1e-6);}), "an RMS norm against another grid is rejected");
+		check(rejects([&]{weightedMaxNorm(square, large, 1e-8, 1e-6);}), "a max norm against another grid is rejected");
+		check(!rejects([&]{dotProduct(square, square);}), "a dot product on one grid is allowed");
+	}
+
+	//an exception in a parallel loop body reaches the caller from the calling thread and from a worker,
+	//and the pool and the nesting flag are left as they were
+	void parallelExceptions()
+	{
+		setParallelExecution(3);
+		for (size_t thrower : {size_t(0), size_t(50)})
+		{
+			bool caught = false;
+			try
+			{
+				parallelFor(100, [&](size_t begin, size_t end)
+				{
+					if (begin <= thrower && thrower < end)
+					{
+						throw std::runtime_error("body failed");
+					}
+				});
+			}
+			catch (const std::runtime_error&)
+			{
+				caught = true;
+			}
+			check(caught, thrower == 0 ? "exception on the calling thread is rethrown" : "exception on a worker is rethrown");
+			check(!insideParallelLoop(), "the nesting flag is restored after an exception");
+		}
+		std::atomic<size_t> ranges(0), covered(0);
+		parallelFor(100, [&](size_t begin, size_t end)
+		{
+			++ranges;
+			covered += end - begin;
+		});
+		check(ranges == 3 && covered == 100, "the pool still runs loops in parallel after an exception");
+		setParallelExecution(1);
+	}
+
+	//contractions of packed tensors agree with the same contractions of the full tensors
+	void packedContractions()
+	{
+		Index<'i'> i;
+		Index<'j'> j;
+		Index<'k'> k;
+		Tensor<3, 2> a;
+		Tensor<3, 1> v;
+		for (size_t n = 0; n < 9; ++n)
+		{
+			a.getData()[n] = double(n * n) - 3.5;
+		}
+		v.getData()[0] = 1;
+		v.getData()[1] = -2;
+		v.getData()[2] = 0.5;
+
+		SymmetricTensor<3, 2> s;
+		s(i, j) = a(i, j) + a(j, i);
+		AntisymmetricTensor<3, 2> w;
+		w(i, j) = a(i, j) - a(j, i);
+		Tensor<3, 2> fullS = s.toTensor(), fullW = w.toTensor();
+		check(s.components == 6 && w.components == 3, "packed component counts");
+
+		Tensor<3, 0> packed, full;
+		packed() = s(i, j) * s(i, j);
+		full() = fullS(i, j) * fullS(i, j);
+		checkClose(*packed.getData(), *full.getData(), 1e-12, "symmetric full contraction");
+		packed() = w(i, j) * w(j, i);
+		full() = fullW(i, j) * fullW(j, i);
+		checkClose(*packed.getData(), *full.getData(), 1e-12, "antisymmetric contraction with swapped indices");
+		packed() = s(i, j) * w(i, j);
+		checkClose(*packed.getData(), 0, 1e-12, "symmetric times antisymmetric vanishes");
+
+		Tensor<3, 1> partial, fullPartial;
+		partial(i) = s(i, j) * v(j);
+		fullPartial(i) = fullS(i, j) * v(j);
+		bool same = true;
+		for (size_t n = 0; n < 3; ++n)
+		{
+			same &= partial.getData()[n] == fullPartial.getData()[n];
+		}
+		check(same, "partial contraction of a packed tensor");
+
+		SymmetricTensor<3, 2> gram;
+		gram(i, j) = a(i, k) * a(j, k);
+		Tensor<3, 2> fullGram;
+		fullGram(i, j) = a(i, k) * a(j, k);
+		Tensor<3, 2> unpacked = gram.toTensor();
+		check(std::equal(unpacked.getData(), unpacked.getData() + 9, fullGram.getData()), "packed result of a contraction");
+	}
+
+	//the integrator advances the caller's state in its own storage and converges at fifth order
+	void integratorSteps()
+	{
+		TensorField<2, 1, 8> state;
+		auto decay = [](const TensorField<2, 1, 8>& input, double, TensorField<2, 1, 8>& output)
+		{
+			linearCombination(output, {-1}, {&input});
+		};
+		auto reset = [&]
+		{
+			double* data = state.getData();
+			for (size_t i = 0; i < state.size() * 2; ++i)
+			{
+				data[i] = 1 + 0.01 * double(i);
+			}
+		};
+		reset();
+		const double* storage = state.getData();
+		CashKarpIntegrator<TensorField<2, 1, 8>> integrator(state);
+		integrator.integrateFixed(state, decay, 0, 1, 0.1);
+		check(state.getData() == storage, "fixed steps keep the state's storage");
+		checkClose(state.getData()[5], 1.05 * std::exp(-1.0), 1e-8, "fixed step accuracy");
+
+		reset();
+		auto error = [](const TensorField<2, 1, 8>& newState, const TensorField<2, 1, 8>& deltaState, const TensorField<2, 1, 8>&, double)
+		{
+			return weightedMaxNorm(deltaState, newState, 1e-10, 1e-8);
+		};
+		check(integrator.integrate(state, decay, error, 0, 2, 0.5), "adaptive integration succeeds");
+		check(state.getData() == storage, "adaptive steps keep the state's storage");
+		checkClose(state.getData()[5], 1.05 * std::exp(-2.0), 1e-7, "adaptive step accuracy");
+
+		double coarse = 1, fine = 1;
+		CashKarpIntegrator<double> scalar(1.0);
+		auto scalarDecay = [](const double& input, double, double& output){output = -input;};
+		scalar.integrateFixed(coarse, scalarDecay, 0, 1, 0.2);
+		scalar.integrateFixed(fine, scalarDecay, 0, 1, 0.1);
+		double ratio = (coarse - std::exp(-1.0)) / (fine - std::exp(-1.0));
+		check(ratio > 25 && ratio < 40, "fifth order convergence");
+	}
+
+	VectorField<Tensor<2, 1>, 2, 6> makeVectorField(double value)
+	{
+		VectorField<Tensor<2, 1>, 2, 6> output;
+		for (size_t i = 0; i < output.dataSize; ++i)
+		{
+			output[i].getData()[0] = value;
+			output[i].getData()[1] = double(i);
+		}
+		return output;
+	}
+
+	//tensors of non floating point scalars scale by their own scalar type
+	void tensorScalars()
+	{
+		Tensor<3, 1, std::complex<double>> t;
+		t.getData()[0] = std::complex<double>(1, 2);
+		t *= std::complex<double>(0, 1);
+		check(t.getData()[0] == std::complex<double>(-2, 1), "complex tensor scaled by a complex scalar");
+		t /= std::complex<double>(0, 1);
+		check(t.getData()[0] == std::complex<double>(1, 2), "complex tensor divided by a complex scalar");
+		t *= 2.0;
+		check(t.getData()[0] == std::complex<double>(2, 4), "complex tensor scaled by a double");
+
+		Tensor<3, 1, float> f;
+		f.getData()[2] = 1.5f;
+		f *= 2.0f;
+		f /= 0.5;
+		checkClose(f.getData()[2], 6, 0, "float tensor scaled by float and double scalars");
+	}
+
+	//lazy VectorField expressions, including ones built from temporary fields
+	void vectorFieldExpressions()
+	{
+		ScalarVectorField<2, 6> a, s;
+		for (size_t i = 0; i < a.dataSize; ++i)
+		{
+			a[i] = double(i);
+			s[i] = 2;
+		}
+		ScalarVectorField<2, 6> b = a + a * 2.0 - 3.0 * a / s + (a + a) / 2.0;
+		checkClose(b[7], 7 * 2.5, 1e-12, "scalar VectorField expression");
+
+		VectorField<Tensor<2, 1>, 2, 6> v = makeVectorField(1);
+		auto expression = makeVectorField(3) + v * 2.0;
+		VectorField<Tensor<2, 1>, 2, 6> w = expression;
+		checkClose(w[5].getData()[0], 5, 0, "expression holding a temporary field");
+		checkClose(w[5].getData()[1], 15, 0, "expression holding a temporary field, second component");
+		w += v * s;
+		checkClose(w[5].getData()[1], 25, 0, "compound assignment of an expression");
+
+		GridTensorField<Extents<6, 6>, 1, double> tensorView = w;
+		tensorView.getData()[5 * 2 + 1] = -1;
+		checkClose(w[5].getData()[1], -1, 0, "tensor field view shares the storage");
+	}
+
+#if defined(__unix__)
+	//a state of fields of every kind and plain values goes through a checkpoint file unchanged,
+	//restored fields are mapped on aligned offsets, and mismatched states or misaligned records are refused
+	void checkpointRoundTrip()
+	{
+		typedef GridTensorField<Extents<6, 7, 5>, 2, float, ComponentMajor> Major;
+		typedef GridTensorField<TiledExtents<4, 8, 8>, 2, double, PointMajor, Symmetric<>> Packed;
+		typedef DirectSum<TensorField<3, 1, 8>, Major, DynamicTensorField<2, 1>, Packed, double, Tensor<3, 1>, DirectSum<double, int>> State;
+		State state;
+		TensorField<3, 1, 8>& field = getReference<0>(state);
+		Major& major = getReference<1>(state);
+		getReference<2>(state) = DynamicTensorField<2, 1>(DynamicExtents<2>({9, 11}));
+		DynamicTensorField<2, 1>& dynamic = getReference<2>(state);
+		Packed& packed = getReference<3>(state);
+		for (size_t i = 0; i < field.size() * 3; ++i)
+		{
+			field.getData()[i] = 0.25 * double(i);
+		}
+		for (size_t i = 0; i < major.size() * 9; ++i)
+		{
+			major.getData()[i] = 0.5f * float(i);
+		}
+		for (size_t i = 0; i < dynamic.size() * 2; ++i)
+		{
+			dynamic.getData()[i] = -double(i);
+		}
+		for (size_t i = 0; i < packed.size() * 3; ++i)
+		{
+			packed.getData()[i] = 1.0 / double(i + 1);
+		}
+		getReference<4>(state) = 3.25;
+		getReference<5>(state).getData()[1] = 7;
+		getReference<6>(state) = DirectSum<double, int>(1.5, 42);
+
+		std::string path = "/tmp/vector_space_checkpoint_" + std::to_string(getpid()) + ".bin";
+		check(saveCheckpoint(path, state, 4096), "checkpoint written in chunks");
+		State restored;
+		check(loadCheckpoint(path, restored), "checkpoint loaded");
+		const TensorField<3, 1, 8>& restoredField = get<0>(restored);
+		bool same = std::equal(field.getData(), field.getData() + field.size() * 3, restoredField.getData())
+			&& std::equal(major.getData(), major.getData() + major.size() * 9, get<1>(restored).getData())
+			&& get<2>(restored).size() == 99
+			&& std::equal(dynamic.getData(), dynamic.getData() + dynamic.size() * 2, get<2>(restored).getData())
+			&& std::equal(packed.getData(), packed.getData() + packed.size() * 3, get<3>(restored).getData())
+			&& get<4>(restored) == 3.25 && get<5>(restored).getData()[1] == 7 && get<6, 0>(restored) == 1.5 && get<6, 1>(restored) == 42;
+		check(same, "every member round trips");
+		check((size_t)restoredField.getData() % checkpointAlignment == 0, "restored fields are page aligned");
+
+		getReference<0>(restored) += get<0>(restored);
+		TensorField<3, 1, 8> single;
+		check(loadCheckpoint(path, restored) && get<0>(restored).getData()[5] == 1.25, "changing a restored field leaves the file alone");
+		check(!loadCheckpoint(path, single), "a single field does not load a whole state");
+		DirectSum<TensorField<3, 1, 8>, TensorField<3, 1, 8>> wrong;
+		check(!loadCheckpoint(path, wrong), "a state of other types is refused");
+
+		//moves the first record's data off the alignment
+		{
+			std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+			size_t position = sizeof(CheckpointFileHeader) + offsetof(CheckpointRecordHeader, dataOffset);
+			uint64_t offset;
+			file.seekg(position);
+			file.read((char*)&offset, sizeof(offset));
+			offset += 8;
+			file.seekp(position);
+			file.write((const char*)&offset, sizeof(offset));
+		}
+		check(!loadCheckpoint(path, restored), "misaligned records are refused");
+		std::remove(path.c_str());
+		check(!loadCheckpoint(path, restored), "a missing file is refused");
+	}
+
+	//scalar tensor of value
+	Tensor<2, 0> scalarTensor(double value)
+	{
+		Tensor<2, 0> output;
+		output.getData()[0] = value;
+		return output;
+	}
+
+	//upwind advection with velocity (1, 0.5) of a block's interior, its ghosts filled
+	template<typename Block>
+	void upwindStep(Block& block, double dt, double h)
+	{
+		DynamicTensorField<2, 0> previous = block.local();
+		const DynamicExtents<2>& grid = previous.getGrid();
+		const std::array<size_t, 2>& extents = block.getInteriorExtents();
+		for (size_t i = 0; i < extents[0]; ++i)
+		{
+			for (size_t j = 0; j < extents[1]; ++j)
+			{
+				size_t point = block.paddedPoint({i, j});
+				const double* u = previous.getData() + point;
+				block.local().getData()[point] = u[0] - dt / h * (u[0] - u[-(long)grid.stride(0)] + 0.5 * (u[0] - u[-1]));
+			}
+		}
+	}
+
+	//adaptive mesh: a linear field comes out exact in every interior and ghost cell (copies between blocks,
+	//coarse-fine interpolation, face centred boundaries, corners), averaging down undoes the interpolation,
+	//a thin front needs a tenth of the cells of the uniform finest grid and subcycled advection matches it
+	void adaptiveMesh()
+	{
+		typedef AdaptiveTensorField<2, 0, 8> Mesh;
+		auto linear = [](const std::array<double, 2>& x){return 1 + 2 * x[0] - 3 * x[1];};
+		Mesh mesh({6, 4}, 1.0 / 48, 3);
+		double h = mesh.spacing(0);
+		mesh.setBoundary(0, 0, GhostBoundary<>::neumann(-2 * h));
+		mesh.setBoundary(0, 1, GhostBoundary<>::neumann(2 * h));
+		mesh.setBoundary(1, 0, GhostBoundary<>::neumann(3 * h));
+		mesh.setBoundary(1, 1, GhostBoundary<>::neumann(-3 * h));
+		//refines towards the corner at (1, 0), so coarse-fine edges meet the domain sides
+		auto corner = [](size_t, const Mesh::Block& block, const std::array<double, 2>&)
+		{
+			return block.local().getData()[block.paddedPoint({0, 0})] > 2.2;
+		};
+		mesh.initialize([&](const std::array<double, 2>& x){return scalarTensor(linear(x));});
+		mesh.regrid(corner);
+		mesh.regrid(corner);
+		mesh.fillGhosts();
+		double largest = 0;
+		for (size_t level = 0; level < mesh.levelCount(); ++level)
+		{
+			for (size_t index = 0; index < mesh.blockCount(level); ++index)
+			{
+				const DynamicTensorField<2, 0>& data = mesh.block(level, index).local();
+				const DynamicExtents<2>& grid = data.getGrid();
+				for (size_t point = 0; point < grid.points; ++point)
+				{
+					std::array<double, 2> centre;
+					for (size_t axis = 0; axis < 2; ++axis)
+					{
+						double cell = double(mesh.blockPosition(level, index)[axis] * 8 + point / grid.stride(axis) % grid.extents[axis]) - 2;
+						centre[axis] = (cell + 0.5) * mesh.spacing(level);
+					}
+					largest = std::max(largest, std::abs(data.getData()[point] - linear(centre)));
+				}
+			}
+		}
+		check(mesh.levelCount() == 3 && mesh.blockCount(1) < 96 && mesh.blockCount(2) < 4 * mesh.blockCount(1), "the corner is refined twice");
+		checkClose(largest, 0, 1e-12, "linear field in every cell and ghost cell");
+
+		mesh.setBoundary(0, 1, GhostBoundary<>::dirichlet(0.5));
+		mesh.fillGhosts();
+		bool faces = true;
+		size_t sides = 0;
+		for (size_t level = 0; level < mesh.levelCount(); ++level)
+		{
+			for (size_t index = 0; index < mesh.blockCount(level); ++index)
+			{
+				const Mesh::Block& block = mesh.block(level, index);
+				if (mesh.blockPosition(level, index)[0] + 1 == (size_t(6) << level))
+				{
+					++sides;
+					for (size_t j = 0; j < 8; ++j)
+					{
+						size_t inside = block.paddedPoint({7, j});
+						faces &= std::abs(block.local().getData()[inside] + block.local().getData()[inside + 12] - 1) < 1e-12;
+					}
+				}
+			}
+		}
+		check(faces && sides > 4, "dirichlet value at the domain face");
+
+		auto wave = [](const std::array<double, 2>& x){return std::sin(6.283185307179586 * x[0]) * std::cos(6.283185307179586 * x[1]);};
+		Mesh smooth({4, 4}, 1.0 / 32, 2);
+		smooth.initialize([&](const std::array<double, 2>& x){return scalarTensor(wave(x));});
+		DynamicTensorField<2, 0> before = smooth.uniformField(0);
+		smooth.regrid([](size_t, const Mesh::Block&, const std::array<double, 2>&){return true;});
+		DynamicTensorField<2, 0> after = smooth.uniformField(0), fine = smooth.uniformField(1);
+		double changed = 0;
+		for (size_t point = 0; point < before.size(); ++point)
+		{
+			changed = std::max(changed, std::abs(after.getData()[point] - before.getData()[point]));
+		}
+		check(smooth.blockCount(1) == 64, "every block refined");
+		checkClose(changed, 0, 1e-13, "averaging down undoes the interpolation");
+		checkClose(normLInf(fine), normLInf(before), 1e-12, "limited interpolation adds no extrema");
+		checkClose(fine.getData()[9 * 64 + 17], wave({9.5 / 64, 17.5 / 64}), 5e-3, "interpolated value (the parent is 0.04 off)");
+
+		auto ring = [](const std::array<double, 2>& x, double width)
+		{
+			return std::tanh((std::hypot(x[0] - 0.5, x[1] - 0.5) - 0.25) / width);
+		};
+		AdaptiveTensorField<2, 0, 4> thin({8, 8}, 1.0 / 32, 7);
+		for (size_t pass = 0; pass < 7; ++pass)
+		{
+			thin.initialize([&](const std::array<double, 2>& x){return scalarTensor(ring(x, 0.0005));});
+			thin.regridByGradient(0.05);
+		}
+		check(thin.levelCount() == 7 && thin.cellCount() * 10 < size_t(2048 * 2048), "ten times fewer cells than the uniform finest grid");
+
+		//the same front moved by upwind steps on three levels and on the uniform finest grid
+		auto front = [&](const std::array<double, 2>& x){return scalarTensor(ring(x, 0.02));};
+		auto step = [](size_t, Mesh::Block& block, double dt, const std::array<double, 2>& spacing){upwindStep(block, dt, spacing[0]);};
+		Mesh adaptive({8, 8}, 1.0 / 64, 3), uniform({32, 32}, 1.0 / 256, 1);
+		for (size_t pass = 0; pass < 3; ++pass)
+		{
+			adaptive.initialize(front);
+			adaptive.regridByGradient(0.1);
+		}
+		adaptive.initialize(front);
+		uniform.initialize(front);
+		double dt = 0.25 / 64;
+		for (size_t n = 0; n < 8; ++n)
+		{
+			adaptive.advance(dt, step);
+			for (size_t substep = 0; substep < 4; ++substep)
+			{
+				uniform.advance(dt / 4, step);
+			}
+		}
+		DynamicTensorField<2, 0> composite = adaptive.uniformField(2), reference = uniform.uniformField(0);
+		double difference = 0;
+		for (size_t point = 0; point < reference.size(); ++point)
+		{
+			difference = std::max(difference, std::abs(composite.getData()[point] - reference.getData()[point]));
+		}
+		check(adaptive.cellCount() < uniform.cellCount(), "advection on fewer cells");
+		checkClose(difference, 0, 5e-4, "subcycled advection matches the uniform fine grid");
+
+		//a field growing at the same rate everywhere: every ghost cell is at the time of its block's step
+		std::mutex lock;
+		double spread = 0;
+		adaptive.initialize([](const std::array<double, 2>&){return scalarTensor(0);});
+		adaptive.advance(dt, [&](size_t, Mesh::Block& block, double blockDt, const std::array<double, 2>&)
+		{
+			double* data = block.local().getData();
+			auto range = std::minmax_element(data, data + block.local().size());
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				spread = std::max(spread, *range.second - *range.first);
+			}
+			for (size_t i = 0; i < 8; ++i)
+			{
+				for (size_t j = 0; j < 8; ++j)
+				{
+					data[block.paddedPoint({i, j})] += blockDt;
+				}
+			}
+		});
+		checkClose(spread, 0, 1e-15, "ghosts interpolated in time while subcycling");
+	}
+
+	//halo planes hold the neighbouring processes' values after an exchange (checked in every process,
+	//a child reports a mismatch by throwing, which run turns into a failed exit status)
+	void haloExchange()
+	{
+		std::array<size_t, 3> extents = {13, 4, 5};
+		auto value = [](size_t globalPoint, size_t component){return double(3 * globalPoint + component);};
+		for (bool periodic : {false, true})
+		{
+			bool exchanged = SharedMemoryTransport::run(3, DistributedTensorField<3, 1, SharedMemoryTransport>::haloMessageBytes(extents),
+				[&](SharedMemoryTransport& transport)
+			{
+				DistributedTensorField<3, 1, SharedMemoryTransport> field(transport, extents, periodic);
+				const SlabDecomposition<3>& slab = field.getDecomposition();
+				double* data = field.local().getData();
+				size_t points = field.local().size();
+				for (size_t point = 0; point < points; ++point)
+				{
+					for (size_t c = 0; c < 3; ++c)
+					{
+						data[point * 3 + c] = slab.owns(slab.globalPoint(point)) ? value(slab.globalPoint(point), c) : -1;
+					}
+				}
+				field.exchangeHalos();
+				for (size_t point = 0; point < points; ++point)
+				{
+					for (size_t c = 0; c < 3; ++c)
+					{
+						if (data[point * 3 + c] != value(slab.globalPoint(point), c))
+						{
+							throw std::runtime_error("wrong halo value");
+						}
+					}
+				}
+			});
+			check(exchanged, periodic ? "periodic halo exchange" : "halo exchange");
+		}
+
+		bool failed = SharedMemoryTransport::run(2, 64, [](SharedMemoryTransport& transport)
+		{
+			if (transport.processRank() == 1)
+			{
+				throw std::runtime_error("child failure");
+			}
+		});
+		check(!failed, "a throwing child is reported as a failure");
+		check(rejects([]
+		{
+			SharedMemoryTransport::run(1, 64, [](SharedMemoryTransport& transport)
+			{
+				char message[128] = {};
+				transport.send(0, 0, message, sizeof(message));
+			});
+		}), "messages over maxMessageBytes are refused");
+		check(rejects([]{SlabDecomposition<3>({5, 4, 4}, 0, 3, 2, false);}), "slabs thinner than the halo are refused");
+	}
+#endif
+}
+
+int main()
+{
+	dynamicGrids();
+	ghostBoundaries();
+	orderedGrids();
+	differentialOperators();
+	reproducibleReductions();
+	parallelExceptions();
+	packedContractions();
+	integratorSteps();
+	tensorScalars();
+	vectorFieldExpressions();
+	adaptiveMesh();
+	checkpointRoundTrip();
+#if defined(__unix__)
+	haloExchange();
+#endif
+
+	if (failures == 0)
+	{
+		std::cerr << "all checks passed" << std::endl;
+	}
+	return (int)failures;
+}
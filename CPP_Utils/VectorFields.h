@@ -2,30 +2,221 @@ namespace SimulationUtilities{
 
 	//need to be able to turn scalar field into rank 0 tensor field
 
-	template<typename VectorType, size_t dimensions, size_t divisions, typename = std::enable_if_t<dimensions!=0 && divisions!=0>>
-	class VectorField
+	template<typename VectorType, typename Grid>
+	class GridVectorField;
+
+	namespace
+	{
+		//lazy vector field arithmetic. operators on fields (and on these expressions) only build
+		//the expression, every point is computed in one loop when it is assigned to a field,
+		//so a + b * s + c / f makes a single pass and no intermediate fields.
+		template<char ID, typename Grid, typename... Ts>
+		struct VectorFieldExpression;
+
+		//field operand. it shares the field's storage (like the TensorField expressions do), so an
+		//expression built from a temporary field, auto e = makeField() + b, stays valid.
+		template<typename Grid, typename VectorType>
+		struct VectorFieldExpression<'f', Grid, VectorType>
+		{
+			std::shared_ptr<VectorType[]> data;
+
+			const VectorType& operator[](size_t index) const
+			{
+				return data[index];
+			}
+		};
+
+		//sum or difference of two operands
+		template<typename Grid, typename Left, typename Right, bool isInverse>
+		struct VectorFieldExpression<'a', Grid, Left, Right, InverseType<isInverse>>
+		{
+			Left left;
+			Right right;
+
+			auto operator[](size_t index) const
+			{
+				if constexpr (isInverse)
+				{
+					return left[index] - right[index];
+				}
+				else
+				{
+					return left[index] + right[index];
+				}
+			}
+		};
+
+		//product or quotient of two operands (one of them usually a scalar field)
+		template<typename Grid, typename Left, typename Right, bool isInverse>
+		struct VectorFieldExpression<'m', Grid, Left, Right, InverseType<isInverse>>
+		{
+			Left left;
+			Right right;
+
+			auto operator[](size_t index) const
+			{
+				if constexpr (isInverse)
+				{
+					return left[index] / right[index];
+				}
+				else
+				{
+					return left[index] * right[index];
+				}
+			}
+		};
+
+		//operand times or divided by a constant
+		template<typename Grid, typename Operand, bool isInverse>
+		struct VectorFieldExpression<'m', Grid, Operand, InverseType<isInverse>>
+		{
+			double scalar;
+			Operand operand;
+
+			auto operator[](size_t index) const
+			{
+				if constexpr (isInverse)
+				{
+					return operand[index] / scalar;
+				}
+				else
+				{
+					return operand[index] * scalar;
+				}
+			}
+		};
+
+		//value is true for fields and field expressions, T is the expression type used for them
+		template<typename Operand>
+		struct Vector_Field_Operand
+		{
+			static constexpr bool value = false;
+		};
+
+		template<typename VectorType, typename Grid>
+		struct Vector_Field_Operand<GridVectorField<VectorType, Grid>>
+		{
+			static constexpr bool value = true;
+			typedef Grid GridType;
+			typedef VectorFieldExpression<'f', Grid, VectorType> T;
+
+			static T get(const GridVectorField<VectorType, Grid>& field)
+			{
+				return {field.data};
+			}
+		};
+
+		template<char ID, typename Grid, typename... Ts>
+		struct Vector_Field_Operand<VectorFieldExpression<ID, Grid, Ts...>>
+		{
+			static constexpr bool value = true;
+			typedef Grid GridType;
+			typedef VectorFieldExpression<ID, Grid, Ts...> T;
+
+			static const T& get(const T& expression)
+			{
+				return expression;
+			}
+		};
+
+		//enabled when Left and Right are both fields or field expressions on the same grid
+		template<typename Left, typename Right>
+		using Vector_Field_Pair = std::enable_if_t<Vector_Field_Operand<Left>::value && Vector_Field_Operand<Right>::value
+			&& std::is_same<typename Vector_Field_Operand<Left>::GridType, typename Vector_Field_Operand<Right>::GridType>::value>;
+
+		template<typename Operand>
+		using Vector_Field_Single = std::enable_if_t<Vector_Field_Operand<Operand>::value>;
+	}
+
+	//vector field on any Extents grid (VectorField is the uniform case)
+	template<typename VectorType, typename Grid>
+	class GridVectorField
 	{
+		static_assert(Grid::dimensions != 0 && Grid::points != 0, "Grid must have points.");
 	public:
-		static constexpr size_t dataSize = Template_Power<divisions, dimensions>::value;
+		static constexpr size_t dimensions = Grid::dimensions;
+		static constexpr size_t dataSize = Grid::points;
 	protected:
-		typedef VectorField<VectorType, dimensions, divisions> SelfType;
-		VectorType data[dataSize];
-	public:
-		VectorField()
+		typedef GridVectorField<VectorType, Grid> SelfType;
+		//on the heap, so large grids do not end up on the stack and moves are cheap
+		std::shared_ptr<VectorType[]> data;
+
+		template<typename Operand>
+		friend struct Vector_Field_Operand;
+
+		//data[i] = expression[i] (or op= with the given update) over the whole field in one loop
+		template<typename Expression, typename Update>
+		void evaluate(const Expression& expression, const Update& update)
 		{
-			for (size_t i = 0; i < dataSize; ++i)
+			VectorType* output = data.get();
+			parallelFor(dataSize, [&](size_t begin, size_t end)
 			{
-				data[i] = VectorType();
-			}
+				for (size_t i = begin; i < end; ++i)
+				{
+					update(output[i], expression[i]);
+				}
+			});
 		}
-		VectorField(const std::vector<VectorType>& input)
+	public:
+		GridVectorField()
+		:
+			data(new VectorType[dataSize]())
+		{}
+		GridVectorField(const std::vector<VectorType>& input)
+		:
+			GridVectorField()
+		{
+			std::copy(input.begin(), input.end(), data.get());
+		}
+		GridVectorField(VectorType* input)
+		:
+			GridVectorField()
 		{
-			std::copy(input.begin(), input.end(), data);
+			std::copy(input, input + dataSize, data.get());
 		}
-		VectorField(VectorType* input)
+		GridVectorField(const SelfType& other)
+		:
+			GridVectorField()
 		{
-			std::copy(input, input + dataSize, data);
+			std::copy(other.data.get(), other.data.get() + dataSize, data.get());
+		}
+		GridVectorField(SelfType&& other) = default;
+
+		//builds the field straight from an expression
+		template<char ID, typename... Ts>
+		GridVectorField(const VectorFieldExpression<ID, Grid, Ts...>& expression)
+		:
+			GridVectorField()
+		{
+			*this = expression;
+		}
+
+		SelfType& operator=(const SelfType& other)
+		{
+			std::copy(other.data.get(), other.data.get() + dataSize, data.get());
+			return *this;
+		}
+		SelfType& operator=(SelfType&& other) = default;
+
+		template<char ID, typename... Ts>
+		SelfType& operator=(const VectorFieldExpression<ID, Grid, Ts...>& expression)
+		{
+			evaluate(expression, [](VectorType& output, const auto& value){output = value;});
+			return *this;
 		}
+		template<char ID, typename... Ts>
+		SelfType& operator+=(const VectorFieldExpression<ID, Grid, Ts...>& expression)
+		{
+			evaluate(expression, [](VectorType& output, const auto& value){output += value;});
+			return *this;
+		}
+		template<char ID, typename... Ts>
+		SelfType& operator-=(const VectorFieldExpression<ID, Grid, Ts...>& expression)
+		{
+			evaluate(expression, [](VectorType& output, const auto& value){output -= value;});
+			return *this;
+		}
+
 		SelfType& operator+=(const SelfType& other)
 		{
 			for (size_t i = 0; i < dataSize; ++i)
@@ -49,7 +240,7 @@ namespace SimulationUtilities{
 			}
 			return *this;
 		}
-		SelfType& operator*=(const VectorField<double, dimensions, divisions>& scalarField)
+		SelfType& operator*=(const GridVectorField<double, Grid>& scalarField)
 		{
 			for (size_t i = 0; i < dataSize; ++i)
 			{
@@ -64,7 +255,7 @@ namespace SimulationUtilities{
 			}
 			return *this;
 		}
-		SelfType& operator/=(const VectorField<double, dimensions, divisions>& scalarField)
+		SelfType& operator/=(const GridVectorField<double, Grid>& scalarField)
 		{
 			for (size_t i = 0; i < dataSize; ++i)
 			{
@@ -85,72 +276,89 @@ namespace SimulationUtilities{
 
 		const VectorType* begin() const
 		{
-			return data;
+			return data.get();
 		}
 
 		const VectorType* end() const
 		{
-			return data + dataSize;
+			return data.get() + dataSize;
 		}
 
-		TensorField<dimensions, 0, divisions, VectorType>& toTensor() const
+		//the tensor field views share this field's storage
+
+		template<typename Q = VectorType, typename = std::enable_if_t<std::is_arithmetic<Q>::value>>
+		GridTensorField<Grid, 0, VectorType> toTensor() const
 		{
-			return *(TensorField<dimensions, 0, divisions, VectorType>*)(this);
+			return {Grid(), std::shared_ptr<VectorType[]>(data)};
 		}
 
 		template<size_t rank, typename T, typename = std::enable_if_t<std::is_same<VectorType, Tensor<dimensions, rank, T>>::value>>
-		operator TensorField<dimensions, rank, divisions, T>&()
+		operator GridTensorField<Grid, rank, T>() const
 		{
-			return *(TensorField<dimensions, rank, divisions, T>*)(this);
+			return {Grid(), std::shared_ptr<T[]>(data, (T*)data.get())};
 		}
 	};
 
+	//vector field on a grid with divisions points along every axis
 	template<typename VectorType, size_t dimensions, size_t divisions>
-	auto operator+(
-		VectorField<VectorType, dimensions, divisions> left, const VectorField<VectorType, dimensions, divisions>& right)
-	{
-		return left += right;
-	}
-	template<typename VectorType, size_t dimensions, size_t divisions>
-	auto operator-(
-		VectorField<VectorType, dimensions, divisions> left, const VectorField<VectorType, dimensions, divisions>& right)
+	using VectorField = GridVectorField<VectorType, typename Uniform_Extents<dimensions, divisions>::T>;
+
+	//the arithmetic operators take fields or expressions and return expressions,
+	//nothing is computed until the result is assigned to a field
+
+	template<typename Left, typename Right, typename = Vector_Field_Pair<Left, Right>>
+	VectorFieldExpression<'a', typename Vector_Field_Operand<Left>::GridType,
+		typename Vector_Field_Operand<Left>::T, typename Vector_Field_Operand<Right>::T, InverseType<false>>
+	operator+(const Left& left, const Right& right)
 	{
-		return left -= right;
+		return {Vector_Field_Operand<Left>::get(left), Vector_Field_Operand<Right>::get(right)};
 	}
-	template<typename VectorType, size_t dimensions, size_t divisions>
-	auto operator*(VectorField<VectorType, dimensions, divisions> left, const double& right)
+	template<typename Left, typename Right, typename = Vector_Field_Pair<Left, Right>>
+	VectorFieldExpression<'a', typename Vector_Field_Operand<Left>::GridType,
+		typename Vector_Field_Operand<Left>::T, typename Vector_Field_Operand<Right>::T, InverseType<true>>
+	operator-(const Left& left, const Right& right)
 	{
-		return left *= right;
+		return {Vector_Field_Operand<Left>::get(left), Vector_Field_Operand<Right>::get(right)};
 	}
-	template<typename VectorType, size_t dimensions, size_t divisions>
-	auto operator*(const double& left, VectorField<VectorType, dimensions, divisions> right)
+	//pointwise product, for a field times a scalar field
+	template<typename Left, typename Right, typename = Vector_Field_Pair<Left, Right>>
+	VectorFieldExpression<'m', typename Vector_Field_Operand<Left>::GridType,
+		typename Vector_Field_Operand<Left>::T, typename Vector_Field_Operand<Right>::T, InverseType<false>>
+	operator*(const Left& left, const Right& right)
 	{
-		return right *= left;
+		return {Vector_Field_Operand<Left>::get(left), Vector_Field_Operand<Right>::get(right)};
 	}
-	template<typename VectorType, size_t dimensions, size_t divisions>
-	auto operator*(
-		VectorField<VectorType, dimensions, divisions> left, const VectorField<double, dimensions, divisions>& right)
+	template<typename Left, typename Right, typename = Vector_Field_Pair<Left, Right>>
+	VectorFieldExpression<'m', typename Vector_Field_Operand<Left>::GridType,
+		typename Vector_Field_Operand<Left>::T, typename Vector_Field_Operand<Right>::T, InverseType<true>>
+	operator/(const Left& left, const Right& right)
 	{
-		return left *= right;
+		return {Vector_Field_Operand<Left>::get(left), Vector_Field_Operand<Right>::get(right)};
 	}
-	template<typename VectorType, size_t dimensions, size_t divisions, typename = std::enable_if_t<!std::is_same<double, VectorType>::value>>
-	auto operator*(
-		const VectorField<double, dimensions, divisions>& left, VectorField<VectorType, dimensions, divisions> right)
+	template<typename Operand, typename = Vector_Field_Single<Operand>>
+	VectorFieldExpression<'m', typename Vector_Field_Operand<Operand>::GridType,
+		typename Vector_Field_Operand<Operand>::T, InverseType<false>>
+	operator*(const Operand& left, double right)
 	{
-		return right *= left;
+		return {right, Vector_Field_Operand<Operand>::get(left)};
 	}
-	template<typename VectorType, size_t dimensions, size_t divisions>
-	auto operator/(VectorField<VectorType, dimensions, divisions> left, const double& right)
+	template<typename Operand, typename = Vector_Field_Single<Operand>>
+	VectorFieldExpression<'m', typename Vector_Field_Operand<Operand>::GridType,
+		typename Vector_Field_Operand<Operand>::T, InverseType<false>>
+	operator*(double left, const Operand& right)
 	{
-		return left /= right;
+		return {left, Vector_Field_Operand<Operand>::get(right)};
 	}
-	template<typename VectorType, size_t dimensions, size_t divisions>
-	auto operator/(VectorField<VectorType, dimensions, divisions> left, const VectorField<double, dimensions, divisions>& right)
+	template<typename Operand, typename = Vector_Field_Single<Operand>>
+	VectorFieldExpression<'m', typename Vector_Field_Operand<Operand>::GridType,
+		typename Vector_Field_Operand<Operand>::T, InverseType<true>>
+	operator/(const Operand& left, double right)
 	{
-		return left /= right;
+		return {right, Vector_Field_Operand<Operand>::get(left)};
 	}
 
+	//double valued VectorField (ScalarField is the rank 0 TensorField)
 	template<size_t dimensions, size_t divisions>
-	using ScalarField = VectorField<double, dimensions, divisions>;
+	using ScalarVectorField = VectorField<double, dimensions, divisions>;
 
-}
\ No newline at end of file
+}
@@ -3,9 +3,45 @@
 #include <iostream>
 #include <tuple>
 #include <math.h>
-// #include <stdexcept>
+#include <stdexcept>
+#include <exception>
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <map>
+#include <set>
+#include <cstddef>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <array>
+#include <new>
+#include <type_traits>
+#include <cstdint>
+#include <string>
+#include <fstream>
+#include <chrono>
+
+#if defined(__unix__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#ifdef SIMULATION_UTILITIES_MPI
+#include <mpi.h>
+#endif
+
+#if defined(__SSE2__) || defined(__AVX__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
 
 //should try using pointers for data to allow for persistent temporaries
 //should try making gradient actualize expression instead of taking tensor
@@ -17,8 +53,14 @@ Index<char indexIdentifier>
 
 DirectSum<VectorTypes...>
 VectorField<VectorType, dimensions, divisions>
+GridVectorField<VectorType, Extents<extents...>>
 Tensor<dimensions, rank, T=double>
-TensorField<dimensions, rank, divisions, T=double>
+PackedTensor<dimensions, rank, Symmetry, T=double>
+TensorField<dimensions, rank, divisions, T=double, Layout=PointMajor, Symmetry=NoSymmetry>
+GridTensorField<Extents<extents...>, rank, T=double, Layout=PointMajor, Symmetry=NoSymmetry>
+DynamicTensorField<dimensions, rank, T=double, Symmetry=NoSymmetry>
+CashKarpIntegrator<State>
+DistributedTensorField<dimensions, rank, Transport, T=double>
 
 
 --------------------------------------------------------------------------------------------------------
@@ -31,7 +73,7 @@ DirectSum<VectorTypes...>
 #instantiated with list of subvalues or default initialized
 
 double DirectSum.dotProduct(other)
-#element by element multiplication added together
+#element by element multiplication added together (dotProduct below, members may be fields)
 
 double DirectSum.defaultSquareMagnitude()
 #returns this->dotProduct(*this)
@@ -49,7 +91,7 @@ project<Is...>(DirectSum<VT...>& input)
 #returns recursive ith element of input by value
 
 double dotProduct(left, right)
-#returns dot product of left and right
+#returns dot product of left and right (see the reductions below)
 
 
 
@@ -61,6 +103,17 @@ VectorField<VectorType, dimensions, divisions>
 #instantiated default or with vector<VectorType> or with VectorType*
 #has [] operator to access element by reference
 #has begin() and end() for forloop purposes.
+#+ - * / between fields (same grid), scalar fields and doubles build expressions, e.g. a + b * s - c / f.
+#nothing is computed until the expression is assigned (=, +=, -= or construction), then every point
+#is evaluated in one loop on the parallel execution threads, with no intermediate fields.
+#values are stored on the heap. a Tensor valued field converts to a GridTensorField sharing its storage,
+#a double valued field does the same through toTensor(). expressions share the storage of their
+#fields, so one built from a temporary field (auto e = makeField() + b) is safe to keep.
+#ScalarVectorField<dimensions, divisions> is VectorField<double, dimensions, divisions>.
+
+GridVectorField<VectorType, Extents<extents...>>
+#VectorField with its own number of points along each axis, e.g. Extents<1024, 1024, 16>.
+#VectorField<VectorType, dimensions, divisions> is GridVectorField with divisions on every axis.
 
 
 
@@ -81,24 +134,280 @@ Tensor<dimensions, rank, T=double>
 vector<T> Tensor.getDataCopy()
 #creates copy of underlying data and passes back as vector<T>
 
+PackedTensor<dimensions, rank, Symmetry, T=double>
+#tensor with an index symmetry that only stores its independent elements.
+#Symmetry is Symmetric<leading=0> or Antisymmetric<leading=0>: every index after the first leading
+#can be exchanged (changing the sign for Antisymmetric). SymmetricTensor<dimensions, rank, T> and
+#AntisymmetricTensor<dimensions, rank, T> are the leading = 0 cases (6 and 3 values for a rank 2 3D tensor).
+#indexed with () like Tensor. assigning to it computes only the stored elements, and a full contraction
+#of two with the same symmetry, S(i, j) * S(i, j), sums over the stored elements only.
+#toTensor() expands it, PackedTensor(tensor) keeps the stored elements of a full tensor.
+
+KroneckerDelta<dimensions, T=double>, LeviCivita<dimensions, T=double>
+#delta(i, j) and epsilon(i, j, k, ...) used like tensors in expressions, but they hold no data and
+#every element is known at compile time. contractions with them only add the terms that can be non zero:
+#A(i, j) * delta(j, k) is A(i, k), w(i) = epsilon(i, j, k) * u(j) * v(k) is the 6 products of the cross
+#product, and curl(i) = epsilon(i, j, k) * grad(j, k) on fields reads only the off diagonal derivatives.
+
 
 
 
 
-TensorField<dimensions, rank, divisions, T=double>
+TensorField<dimensions, rank, divisions, T=double, Layout=PointMajor>
 #based on VectorField<Tensor<dimensions, rank, T>, dimensions, divisions>
 #uses same intuitive tensor arithmetic with () operator
 #instantiated with default, vector<Tensor<dimensions, rank, T>>, or Tensor<dimensions, rank, T>*
+#+=, -=, *= and /= run as one flat SIMD loop over the whole field (SSE2, AVX/AVX2 or AVX-512,
+#whichever the compiler targets. define SIMULATION_UTILITIES_NO_SIMD to get plain loops)
+#Layout is PointMajor (each point's tensor contiguous) or ComponentMajor (each component
+#contiguous over the grid). expressions and gradients work the same with either.
+#[] gives Tensor& (PointMajor only), getTensor/setTensor copy a point's tensor out/in with either layout
+#field expression assignments (=, +=, -=) and the compound operators run on the parallel execution threads
+#Symmetry (Symmetric<> or Antisymmetric<>) stores a PackedTensor per point, e.g. a symmetric rank 2 3D field
+#takes 6 instead of 9 scalars per point. everything above (and checkpoints, linearCombination) works the same.
+#T = float works end to end in float arithmetic (SIMD at twice the width, gradients included) and double
+#scalars convert, e.g. F * 0.5 or F *= dt. GridTensorField<Grid, rank, float>(doubleField) converts a field
+#to float and back. define SIMULATION_UTILITIES_MIXED_PRECISION to keep float storage but sum contractions
+#and DirectSum dot products in double.
+
+
+
+
+
+gradient_ignoreBoundary<order=4>(field, dx), gradient_periodicBoundary<order=4>(field, dx)
+#gradient as a rank + 1 TensorField, derivative direction is the first index
+#order is 2, 4, 6 or 8, e.g. gradient_periodicBoundary<6>(F, dx). the stencil coefficients (central and
+#one sided) are derived at compile time, every axis needs at least order + 1 points.
+#the gradient of a Symmetric<n> (Antisymmetric<n>) field is a Symmetric<n + 1> (Antisymmetric<n + 1>) field
+
+secondDerivative_ignoreBoundary<order=4>(field, dx), secondDerivative_periodicBoundary<order=4>(field, dx)
+#second derivative along each axis, laid out like the gradient (the laplacian is its trace).
+#the one sided stencils at non periodic boundaries are one order lower.
+
+lazyGradient_ignoreBoundary<order=4>(field, dx), lazyGradient_periodicBoundary<order=4>(field, dx)
+lazySecondDerivative_ignoreBoundary<order=4>(field, dx), lazySecondDerivative_periodicBoundary<order=4>(field, dx)
+#same derivatives, evaluated on demand inside field expressions (no rank + 1 field is built)
+#grad = lazyGradient_ignoreBoundary(F, dx); div() = grad(i, i); adv(i) = v(j) * grad(j, i);
+
+divergence_ignoreBoundary<order=4>(field, dx), curl_...(field, dx), laplacian_...(field, dx), advect_...(velocity, field, dx)
+#(each also with _periodicBoundary) the usual operators as one pass of the gradient stencil engine each, on the
+#parallel execution threads, without rank + 1 temporaries (only the derivatives an operator reads are computed).
+#divergence contracts the derivative with the first index (rank - 1 result, keeping the symmetry of the other
+#indices), curl is for 3D vector fields, laplacian uses the compact second derivative stencil (not the gradient
+#twice), advect is v(j) * d_j field (velocity on another run time grid throws std::invalid_argument).
+#order and spacing work as for the gradients.
+
+
+
+
+
+setParallelExecution(threads, schedule=Schedule::Static, chunkSize=4096)
+#sets the thread pool used for field assignments and compound operators.
+#threads = 1 is serial (default), 0 uses every hardware thread.
+#Schedule::Static splits the grid evenly, Schedule::Dynamic hands out chunkSize blocks.
+#results are identical to serial evaluation. an exception thrown inside a parallel loop (e.g. from an
+#AMR step functor) is rethrown on the calling thread once every thread has stopped.
+
+
+
+
+
+BufferPool
+#TensorField storage comes from a pool of cached buffers (size classes, 64 byte aligned), a dropped
+#field's buffer is reused by the next field of that size, so steady state time steps do not allocate.
+#currentBufferPool() gives the pool used on this thread, bufferPoolStatistics() its hits, misses,
+#bytesInUse, peakBytes and cachedBytes. currentBufferPool()->trim() frees the cached buffers.
+#currentBufferPool()->setAllocator({allocate, deallocate}) replaces where the memory comes from
+#(only while no buffer is in use, returns false otherwise). currentBufferPool()->setCacheLimit(bytes)
+#caps the cached bytes (1 GiB by default), released buffers beyond it are freed at once.
+
+setThreadLocalBufferPools(threadLocal)
+#true gives every thread its own pool, buffers always go back to the pool they came from.
+
+
+
+
+
+bool saveCheckpoint(path, state)
+#writes a TensorField, DirectSum (of fields, tensors, doubles, ...) or plain value as one binary file.
+#the header records dimensions, rank, extents, scalar type and layout of every field,
+#field data is page aligned.
+
+bool loadCheckpoint(path, state)
+#restores a saveCheckpoint file into state (false if the types or shapes do not match).
+#fields are memory mapped from the file (copy on write), so nothing is parsed or copied up front.
+
+
+SnapshotWriter<State>
+#saves checkpoints on a background thread. instantiated with (pathPrefix, prototype state,
+#queueDepth=2, cadence=1, backPressure=SnapshotBackPressure::Block, chunkBytes=64MB).
+#submit(step, state) copies state into a free buffer and returns, files are pathPrefix<step>.bin.
+#when every buffer is busy Block waits (counted as stall time) and Drop skips the snapshot.
+#flush() waits for the queue, getStatistics() gives written, dropped, failed, bytes, stallSeconds, writeSeconds.
+
+
+
+
+
+GhostedTensorField<dimensions, rank, T=double, ghosts=2>
+#tensor field with ghosts layers of ghost cells around an interior of run time extents, instantiated with
+#({interior extents...}). setBoundary(axis, side, boundary) or setBoundary(boundary) picks
+#GhostBoundary<T>::periodic(), dirichlet(value), neumann(value=0) or reflective() (mirror that flips the
+#components along the axis) for each side, fillGhosts() sets every ghost cell (one parallel pass per axis).
+#the boundary is the edge point, or half a spacing beyond it for boundary.atFace() (cell centred data).
+#external() sides are left alone, for ghost cells the caller fills.
+#gradient<order=4>(field, dx) and secondDerivative<order=4>(field, dx) then run the central stencil on
+#every interior point, without wrapping or one sided stencils (ghosts must be at least order / 2).
+#local() is the padded DynamicTensorField, paddedPoint({position...}) the index of an interior point in it,
+#setInterior(field) and getInterior() copy an unpadded field in and out.
+
+AdaptiveTensorField<dimensions, rank, blockSize=16, T=double, ghosts=2>
+#block structured AMR, instantiated with ({level 0 blocks per axis...}, level 0 spacing, maxLevels).
+#every level is a set of blockSize^dimensions cell blocks, each a GhostedTensorField (block(level, i)),
+#level l + 1 refines chosen level l blocks by 2. cells are centred, cell i of level l at (i + 0.5) * spacing(l).
+#initialize(f) sets every cell to f({x, y, ...}) (a Tensor<dimensions, rank, T>).
+#regrid(refine) rebuilds the levels above 0 (at most one new level per call) from refine(level, block, spacing),
+#regridByGradient(threshold) refines where the change between neighbouring cells is above threshold.
+#new blocks are interpolated from the level below (limited linear, conserving averages), averageDown()
+#makes covered coarse cells the average of their children. fillGhosts() copies every block's ghosts from its
+#neighbours on the level, interpolates them from the level below at coarse-fine edges, or sets them from the
+#boundary conditions (setBoundary, periodic by default) taken at the cell faces, neumann values being for
+#the level 0 spacing.
+#advance(dt, step) subcycles: step(level, block, dt, spacing) is called on every block with ghosts filled,
+#level l takes 2^l steps of dt / 2^l with coarse-fine ghosts interpolated in time.
+#uniformField(level) gives the whole domain at that level's resolution, cellCount() the cells on every level.
+
+
+
+
+GridTensorField<Extents<extents...>, rank, T=double, Layout=PointMajor>
+#TensorField with its own number of points along each axis (at least 5 each), same api.
+#Extents is row major. TiledExtents<tile, extents...> stores tile^dimensions blocks contiguously (every extent
+#a multiple of tile) and MortonExtents<extents...> uses Z order (equal power of two extents), so stencil
+#neighbours along every axis stay close in memory. expressions, gradients and checkpoints work the same,
+#gradients on them go tile by tile (Z order block by block for Morton) in parallel, and TiledExtents::stride(axis)
+#is the neighbour distance inside a tile.
+#the grid maps positions and point indices: index({x, y, z}), coordinate(point, axis), moveTo(point, axis, x).
+#TensorField<dimensions, rank, divisions, T, Layout> is GridTensorField with divisions on every axis.
+#gradients and lazy gradients take either one spacing dx or one spacing per axis ({dx, dy, dz}).
+
+
+DynamicTensorField<dimensions, rank, T=double>
+#GridTensorField on a DynamicExtents<dimensions> grid, extents are picked at run time:
+#DynamicTensorField<3, 1> F(DynamicExtents<3>({nx, ny, nz}));
+#storage is on the heap, same expression api, compound operators and gradients (PointMajor only).
+#size() is the number of points and stride(axis) the distance between neighbours along axis.
+#gradients throw std::invalid_argument if an axis has fewer than order + 1 points, and
+#linearCombination, +=, -= and expression assignments throw it for fields on different grids.
+
+
+
+
+
+linearCombination(output, {weights...}, {&inputs...})
+#output = weights[0] * inputs[0] + weights[1] * inputs[1] + ... for doubles, Tensors, TensorFields and
+#DirectSums of them. fields are swept once (SIMD, on the parallel execution threads) reading every
+#input once, with no temporaries. output may be one of the inputs.
+
+axpy(a, x, y), axpby(a, x, b, y)
+#y = a * x + y and y = a * x + b * y through linearCombination
+
+sumOf(x), dotProduct(x, y), normL2(x), normLInf(x), minimumOf(x), maximumOf(x)
+#reductions over every stored scalar of doubles, Tensors, TensorFields and DirectSums of them.
+#fields are reduced on the parallel execution threads in fixed blocks combined in a fixed tree,
+#so the result is bitwise the same for any thread count or schedule. single Tensors are reduced
+#with a plain serial loop (same lanes and tree), so small ODE states stay cheap. fields on
+#different grids throw std::invalid_argument.
+
+weightedRmsNorm(error, reference, absoluteTolerance, relativeTolerance), weightedMaxNorm(...)
+#RMS (max) over every scalar of error / (absoluteTolerance + relativeTolerance * |reference|),
+#e.g. the CashKarpIntegrator error functor returns weightedRmsNorm(deltaState, newState, 1e-8, 1e-6)
+
+
+
+
+
+CashKarpIntegrator<State>
+#embedded RK45 integrator (C++ version of Python_Utils/rk4_code.py) for any State with a copy constructor and
+#linearCombination, e.g. DirectSum<...> or TensorField<...>. instantiated with a prototype state, all stage
+#buffers are made up front so steps do not allocate. each stage is built with one linearCombination.
+#derivative(const State& state, double t, State& output) must overwrite output,
+#error(newState, deltaState, derivative, dt) returns estimated error / allowed error, with deltaState the
+#fourth order minus the fifth order result.
+
+void step(state, derivative, t, dt)
+#one fixed step, state updated in place (its storage is kept, getData() pointers stay valid)
+
+bool fullStep(state, derivative, error, t, dt)
+#one adaptive step, advances state and t and sets dt to the next step size (false if it kept failing)
+
+bool integrate(state, derivative, error, t0, t1, dt, observer=none)
+void integrateFixed(state, derivative, t0, t1, dt, observer=none)
+#loop steps up to t1, calling observer(state, t) after every step
+
+
+
+
+
+DistributedTensorField<dimensions, rank, Transport, T=double>
+#a TensorField split into slabs along axis 0 over several processes, each with ghost planes
+#(2 by default, the fourth order stencil radius, order / 2 are needed for other orders) next to its neighbours.
+#instantiated with (transport, {global extents...}, periodic=false, halo=2).
+#local() is the process's block as a DynamicTensorField, so expressions and gradients run on it directly.
+#beginHaloExchange() / finishHaloExchange() fill the ghost planes, work that does not touch the
+#ghost planes can run in between. exchangeHalos() does both.
+#getDecomposition() gives the owned planes and localPoint(globalPoint) / globalPoint(localPoint).
+
+SharedMemoryTransport::run(processes, maxMessageBytes, body(transport))
+#forks the processes on one machine, they exchange through shared memory.
+#DistributedTensorField<...>::haloMessageBytes({global extents...}) gives maxMessageBytes.
+
+MpiTransport(communicator=MPI_COMM_WORLD)
+#define SIMULATION_UTILITIES_MPI (and link MPI) to exchange over MPI instead.
 
 
 */
 
 #include "TemplateHelpers.h"
 
-#include "DirectSums.h"
+#include "SimdKernels.h"
 
-// #include "VectorFields.h"
+#include "Parallel.h"
+
+#include "BufferPool.h"
+
+#include "DirectSums.h"
 
 #include "Tensors.h"
+
+#include "SymmetricTensors.h"
+
+#include "SymbolicTensors.h"
+
+#include "Grids.h"
+
+#include "FieldLayouts.h"
+
+#include "Stencils.h"
 // using namespace std;
 #include "TensorFields.h"
+
+#include "VectorFields.h"
+
+#include "DifferentialOperators.h"
+
+#include "GhostCells.h"
+
+#include "LinearCombinations.h"
+
+#include "Reductions.h"
+
+#include "AdaptiveMesh.h"
+
+#include "Checkpoint.h"
+
+#include "Snapshots.h"
+
+#include "Integrators.h"
+
+#include "Decomposition.h"